@@ -2,21 +2,63 @@
 #include "hmath.h"
 
 #include "hmathanalysis.h"
+#include "hmathautodiff.h"
+#include "hmathbatchsolver.h"
 #include "hmathbitops.h"
+#include "hmathbytecode.h"
 #include "hmathconfig.h"
 #include "hmathconstants.h"
 #include "hmathfunctionsequence.h"
+#include "hmathmemoize.h"
 #include "hmathpolynomial.h"
+#include "hmathpolynomialroots.h"
+#include "hmathtape.h"
+#include "hmaththreadpool.h"
 #include "hmathutil.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <new>
 
 
+#if DO_TEST
+namespace
+{
+	std::atomic<size_t> allocationCount = 0;
+}
+
+void* operator new(size_t size)
+{
+	++allocationCount;
+
+	if (void* ptr = std::malloc(size == 0 ? 1 : size))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+#endif // DO_TEST
+
 namespace hmath
 {
 
 #if DO_TEST
+size_t GetAllocationCount()
+{
+	return allocationCount.load();
+}
+
 bool DoTest()
 {
 	using namespace std;
@@ -28,9 +70,17 @@ bool DoTest()
 	cout << "[HMath] Test Started! ===" << endl;
 
 	errorCount += bitops::DoTest(testCount, errorMessages);
+	errorCount += ThreadPool::DoTest(testCount, errorMessages);
 	errorCount += util::DoTest(testCount, errorMessages);
+	errorCount += FunctionSequence::DoTest(testCount, errorMessages);
 	errorCount += Polynomial::DoTest(testCount, errorMessages);
+	errorCount += roots::DoTest(testCount, errorMessages);
 	errorCount += analysis::DoTest(testCount, errorMessages);
+	errorCount += MemoizedFunction::DoTest(testCount, errorMessages);
+	errorCount += autodiff::DoTest(testCount, errorMessages);
+	errorCount += autodiff::Tape::DoTest(testCount, errorMessages);
+	errorCount += batch::DoTest(testCount, errorMessages);
+	errorCount += bytecode::DoTest(testCount, errorMessages);
 
 	cout << endl;
 	cout << "[HMath] Test Finished! ===" << endl;
@@ -3,6 +3,7 @@
 #include "hmathconfig.h"
 #include "hmathtypes.h"
 
+#include <cstddef>
 #include <initializer_list>
 #include <string>
 #include <vector>
@@ -12,5 +13,8 @@ namespace hmath
 {
 #if DO_TEST
 	bool DoTest();
+
+	// Number of global operator new calls so far, for tests that verify allocation-free paths.
+	size_t GetAllocationCount();
 #endif // DO_TEST
 } // hmath
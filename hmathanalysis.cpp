@@ -1,10 +1,13 @@
 #include "hmathanalysis.h"
 
+#include "hmathautodiff.h"
 #include "hmathbitops.h"
 #include "hmathutil.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 
 
@@ -13,7 +16,7 @@ namespace hmath
 namespace analysis
 {
 
-HReal derivativeFromBelow(const TFunc1& func, HReal x, HReal epsilon)
+HReal derivativeFromBelow(FunctionRef func, HReal x, HReal epsilon)
 {
 	if (!func)
 	{
@@ -30,7 +33,7 @@ HReal derivativeFromBelow(const TFunc1& func, HReal x, HReal epsilon)
 	return y;
 }
 
-HReal derivativeFromAbove(const TFunc1& func, HReal x, HReal epsilon)
+HReal derivativeFromAbove(FunctionRef func, HReal x, HReal epsilon)
 {
 	if (!func)
 	{
@@ -47,7 +50,7 @@ HReal derivativeFromAbove(const TFunc1& func, HReal x, HReal epsilon)
 	return y;
 }
 
-HReal derivative(const TFunc1& func, HReal x, HReal epsilon)
+HReal derivative(FunctionRef func, HReal x, HReal epsilon)
 {
 	if (!func)
 	{
@@ -65,7 +68,7 @@ HReal derivative(const TFunc1& func, HReal x, HReal epsilon)
 	return y;
 }
 
-HReal secondOrderDerivativeFromBelow(const TFunc1& func, HReal x, HReal epsilon)
+HReal secondOrderDerivativeFromBelow(FunctionRef func, HReal x, HReal epsilon)
 {
 	if (!func)
 	{
@@ -76,13 +79,17 @@ HReal secondOrderDerivativeFromBelow(const TFunc1& func, HReal x, HReal epsilon)
 
 	assert(epsilon > 0);
 
-	auto dy = getDerivativeFromBelow(func, epsilon);
+	auto dy = [func, epsilon](HReal value) -> HReal
+	{
+		return derivativeFromBelow(func, value, epsilon);
+	};
+
 	auto ddy = derivativeFromBelow(dy, x, epsilon);
 
 	return ddy;
 }
 
-HReal secondOrderDerivativeFromAbove(const TFunc1& func, HReal x, HReal epsilon)
+HReal secondOrderDerivativeFromAbove(FunctionRef func, HReal x, HReal epsilon)
 {
 	if (!func)
 	{
@@ -93,13 +100,17 @@ HReal secondOrderDerivativeFromAbove(const TFunc1& func, HReal x, HReal epsilon)
 
 	assert(epsilon > 0);
 
-	auto dy = getDerivativeFromAbove(func, epsilon);
+	auto dy = [func, epsilon](HReal value) -> HReal
+	{
+		return derivativeFromAbove(func, value, epsilon);
+	};
+
 	auto ddy = derivativeFromAbove(dy, x, epsilon);
 
 	return ddy;
 }
 
-HReal secondOrderDerivative(const TFunc1& func, HReal x, HReal epsilon)
+HReal secondOrderDerivative(FunctionRef func, HReal x, HReal epsilon)
 {
 	if (!func)
 	{
@@ -110,7 +121,11 @@ HReal secondOrderDerivative(const TFunc1& func, HReal x, HReal epsilon)
 
 	assert(epsilon > 0);
 
-	auto dy = getDerivative(func, epsilon);
+	auto dy = [func, epsilon](HReal value) -> HReal
+	{
+		return derivative(func, value, epsilon);
+	};
+
 	auto ddy = derivative(dy, x, epsilon);
 
 	return ddy;
@@ -231,7 +246,7 @@ TFunc1 getSecondOrderDerivative(const TFunc1& func, HReal epsilon)
 }
 
 std::optional<HRoot> bisectionMethod(int& outIterationCount,
-	const TFunc1& continuousFunc, HReal start, HReal end,
+	FunctionRef continuousFunc, HReal start, HReal end,
 	int maxCount, HReal epsilon)
 {
 	using namespace bitops;
@@ -241,11 +256,11 @@ std::optional<HRoot> bisectionMethod(int& outIterationCount,
 	HReal sy = continuousFunc(start);
 	HReal ey = continuousFunc(end);
 	
-	HReal error = abs(sy);
+	HReal error = std::abs(sy);
 	if (error < epsilon)
 		return HRoot{ start, error };
 
-	error = abs(ey);
+	error = std::abs(ey);
 	if (error < epsilon)
 		return HRoot{ end, error };
 
@@ -257,14 +272,14 @@ std::optional<HRoot> bisectionMethod(int& outIterationCount,
 
 	HReal deltaRange = end - start;
 	
-	while (!isNegative(deltaRange) && abs(deltaRange) > epsilon && outIterationCount < maxCount)
+	while (!isNegative(deltaRange) && std::abs(deltaRange) > epsilon && outIterationCount < maxCount)
 	{
 		++outIterationCount;
 
 		HReal x = start + (deltaRange * HALF);
 		HReal y = continuousFunc(x);
 
-		error = abs(y);
+		error = std::abs(y);
 		if (error < epsilon)
 			return HRoot{ x, error };
 
@@ -289,14 +304,14 @@ std::optional<HRoot> bisectionMethod(int& outIterationCount,
 }
 
 std::optional<HRoot> newtonRaphsonMethod(int& outIterationCount,
-	const TFunc1& func, const TFunc1& derivativeFunc, HReal start,
+	FunctionRef func, FunctionRef derivativeFunc, HReal start,
 	int maxCount, HReal epsilon)
 {
 	outIterationCount = 0;
 
 	auto x = start;
 	auto y = func(x);
-	auto error = abs(y);
+	auto error = std::abs(y);
 	if (error < epsilon)
 		return HRoot{ x, error };
 
@@ -305,13 +320,13 @@ std::optional<HRoot> newtonRaphsonMethod(int& outIterationCount,
 		++outIterationCount;
 
 		auto dy = derivativeFunc(x);
-		if (abs(dy) < DIV_EPSILON)
+		if (std::abs(dy) < DIV_EPSILON)
 			return std::optional<HRoot>();
 
 		x = x - (y / dy);
 		y = func(x);
 
-		error = abs(y);
+		error = std::abs(y);
 		if (error < epsilon)
 			return HRoot{ x, error };
 	}
@@ -320,15 +335,20 @@ std::optional<HRoot> newtonRaphsonMethod(int& outIterationCount,
 }
 
 std::optional<HRoot> newtonRaphsonMethod(int& outIterationCount,
-	const TFunc1& differentiableFunc, HReal start,
+	FunctionRef differentiableFunc, HReal start,
 	int maxCount, HReal epsilon)
 {
+	auto derivativeFunc = [differentiableFunc](HReal value) -> HReal
+	{
+		return derivative(differentiableFunc, value);
+	};
+
 	return newtonRaphsonMethod(outIterationCount, differentiableFunc,
-		getDerivative(differentiableFunc), start, maxCount, epsilon);
+		derivativeFunc, start, maxCount, epsilon);
 }
 
 std::optional<HRoot> secantMethod(int& outIterationCount,
-	const TFunc1& func, HReal start, HReal start2,
+	FunctionRef func, HReal start, HReal start2,
 	int maxCount, HReal epsilon)
 {
 	outIterationCount = 0;
@@ -338,11 +358,11 @@ std::optional<HRoot> secantMethod(int& outIterationCount,
 	auto y1 = func(x1);
 	auto y2 = func(x2);
 
-	auto error = abs(y1);
+	auto error = std::abs(y1);
 	if (error < epsilon)
 		return HRoot{ x1, error };
 
-	error = abs(y2);
+	error = std::abs(y2);
 	if (error < epsilon)
 		return HRoot{ x2, error };
 
@@ -351,11 +371,11 @@ std::optional<HRoot> secantMethod(int& outIterationCount,
 		++outIterationCount;
 
 		auto dx = x2 - x1;
-		if (abs(dx) < DIV_EPSILON)
+		if (std::abs(dx) < DIV_EPSILON)
 			return std::optional<HRoot>();
 		
 		auto dy = (y2 - y1) / dx;
-		if (abs(dy) < DIV_EPSILON)
+		if (std::abs(dy) < DIV_EPSILON)
 			return std::optional<HRoot>();
 
 		auto oldX = x1;
@@ -367,26 +387,418 @@ std::optional<HRoot> secantMethod(int& outIterationCount,
 		x2 = x2 - (y2 / dy);
 		y2 = func(x2);
 
-		error = abs(y2);
+		error = std::abs(y2);
 		if (error < epsilon)
 			return HRoot{ x2, error };
 	}
 
 	return std::optional<HRoot>();
 }
-		
+
+std::optional<HRoot> brentMethod(int& outIterationCount,
+	FunctionRef continuousFunc, HReal start, HReal end,
+	int maxCount, HReal epsilon)
+{
+	outIterationCount = 0;
+
+	HReal a = start;
+	HReal b = end;
+	HReal fa = continuousFunc(a);
+	HReal fb = continuousFunc(b);
+
+	if (std::abs(fa) < epsilon)
+		return HRoot{ a, std::abs(fa) };
+
+	if (std::abs(fb) < epsilon)
+		return HRoot{ b, std::abs(fb) };
+
+	if (std::signbit(fa) == std::signbit(fb))
+		return std::optional<HRoot>();
+
+	HReal c = a;
+	HReal fc = fa;
+	HReal d = b - a;
+	HReal e = d;
+
+	while (outIterationCount < maxCount)
+	{
+		++outIterationCount;
+
+		// b is the best estimate, and the root is between b and c.
+		if (std::signbit(fb) == std::signbit(fc))
+		{
+			c = a;
+			fc = fa;
+			d = b - a;
+			e = d;
+		}
+
+		if (std::abs(fc) < std::abs(fb))
+		{
+			a = b;
+			b = c;
+			c = a;
+			fa = fb;
+			fb = fc;
+			fc = fa;
+		}
+
+		const HReal tolerance = TWO * MACHINE_EPSILON * std::abs(b) + MIN_NUMBER;
+		const HReal middle = HALF * (c - b);
+
+		// The bracket can't be narrowed anymore.
+		if (std::abs(middle) <= tolerance)
+			return std::optional<HRoot>();
+
+		if (std::abs(e) >= tolerance && std::abs(fa) > std::abs(fb))
+		{
+			// Secant if a and c are the same point, inverse quadratic interpolation otherwise.
+			const HReal s = fb / fa;
+			HReal p = ZERO;
+			HReal q = ZERO;
+
+			if (a == c)
+			{
+				p = TWO * middle * s;
+				q = ONE - s;
+			}
+			else
+			{
+				const HReal qa = fa / fc;
+				const HReal r = fb / fc;
+
+				p = s * (TWO * middle * qa * (qa - r) - (b - a) * (r - ONE));
+				q = (qa - ONE) * (r - ONE) * (s - ONE);
+			}
+
+			if (p > ZERO)
+			{
+				q = -q;
+			}
+
+			p = std::abs(p);
+
+			// Accepts the interpolation only if it falls inside the bracket and converges fast enough.
+			const HReal bound1 = 3 * middle * q - std::abs(tolerance * q);
+			const HReal bound2 = std::abs(e * q);
+
+			if (TWO * p < std::min(bound1, bound2))
+			{
+				e = d;
+				d = p / q;
+			}
+			else
+			{
+				d = middle;
+				e = d;
+			}
+		}
+		else
+		{
+			d = middle;
+			e = d;
+		}
+
+		a = b;
+		fa = fb;
+
+		b += std::abs(d) > tolerance ? d : std::copysign(tolerance, middle);
+		fb = continuousFunc(b);
+
+		if (std::abs(fb) < epsilon)
+			return HRoot{ b, std::abs(fb) };
+	}
+
+	return std::optional<HRoot>();
+}
+
+std::optional<HRoot> itpMethod(int& outIterationCount,
+	FunctionRef continuousFunc, HReal start, HReal end,
+	int maxCount, HReal epsilon)
+{
+	outIterationCount = 0;
+
+	HReal a = std::min(start, end);
+	HReal b = std::max(start, end);
+	HReal ya = continuousFunc(a);
+	HReal yb = continuousFunc(b);
+
+	if (std::abs(ya) < epsilon)
+		return HRoot{ a, std::abs(ya) };
+
+	if (std::abs(yb) < epsilon)
+		return HRoot{ b, std::abs(yb) };
+
+	if (std::signbit(ya) == std::signbit(yb))
+		return std::optional<HRoot>();
+
+	// The method is defined for f(a) < 0 < f(b), so f is negated otherwise.
+	const HReal sign = std::signbit(ya) ? ONE : MINUS_ONE;
+	ya *= sign;
+	yb *= sign;
+
+	// Hyper-parameters recommended by the authors: k1 = 0.2 / (b - a), k2 = 2, n0 = 1.
+	const HReal tolerance = TWO * MACHINE_EPSILON * std::max(std::abs(a), std::abs(b)) + MIN_NUMBER;
+	const HReal k1 = 0.2 / (b - a);
+	const int maxHalvings = static_cast<int>(std::ceil(std::log2((b - a) / (TWO * tolerance)))) + 1;
+
+	for (int j = 0; b - a > TWO * tolerance && outIterationCount < maxCount; ++j)
+	{
+		++outIterationCount;
+
+		const HReal width = b - a;
+		const HReal xHalf = HALF * (a + b);
+		const HReal radius = tolerance * std::ldexp(ONE, std::max(0, maxHalvings - j)) - HALF * width;
+
+		// Interpolation
+		const HReal xRegulaFalsi = (yb * a - ya * b) / (yb - ya);
+
+		// Truncation
+		const HReal sigma = std::copysign(ONE, xHalf - xRegulaFalsi);
+		const HReal delta = k1 * width * width;
+		const HReal xTruncated = delta <= std::abs(xHalf - xRegulaFalsi) ? xRegulaFalsi + sigma * delta : xHalf;
+
+		// Projection onto the minmax interval around the bisection point
+		const HReal x = std::abs(xTruncated - xHalf) <= radius ? xTruncated : xHalf - sigma * radius;
+		const HReal y = continuousFunc(x);
+
+		if (std::abs(y) < epsilon)
+			return HRoot{ x, std::abs(y) };
+
+		if (sign * y > ZERO)
+		{
+			b = x;
+			yb = sign * y;
+		}
+		else
+		{
+			a = x;
+			ya = sign * y;
+		}
+	}
+
+	return std::optional<HRoot>();
+}
+
+namespace
+{
+	// Golden-section search for the minimum of |f| on [a, b].
+	HRoot minimizeAbs(FunctionRef func, HReal a, HReal b, int maxCount = 100)
+	{
+		const HReal inverseGolden = HALF * (std::sqrt(static_cast<HReal>(5)) - ONE);
+
+		HReal x1 = b - inverseGolden * (b - a);
+		HReal x2 = a + inverseGolden * (b - a);
+		HReal y1 = std::abs(func(x1));
+		HReal y2 = std::abs(func(x2));
+
+		for (int i = 0; i < maxCount && b - a > TWO * MACHINE_EPSILON * std::abs(x1) + MIN_NUMBER; ++i)
+		{
+			if (y1 < y2)
+			{
+				b = x2;
+				x2 = x1;
+				y2 = y1;
+				x1 = b - inverseGolden * (b - a);
+				y1 = std::abs(func(x1));
+			}
+			else
+			{
+				a = x1;
+				x1 = x2;
+				y1 = y2;
+				x2 = a + inverseGolden * (b - a);
+				y2 = std::abs(func(x2));
+			}
+		}
+
+		return y1 < y2 ? HRoot{ x1, y1 } : HRoot{ x2, y2 };
+	}
+
+	std::vector<HRoot> findAllRootsOn(ThreadPool* pool, FunctionRef continuousFunc, HReal start, HReal end,
+		HReal step, HReal epsilon)
+	{
+		// Chunks on the pool, or serially on the calling thread without one.
+		auto forEachChunk = [pool](size_t count, size_t chunkSize, const auto& func)
+		{
+			if (pool != nullptr)
+			{
+				pool->parallelFor(count, chunkSize, func);
+			}
+			else
+			{
+				ThreadPool::serialFor(count, chunkSize, func);
+			}
+		};
+
+		if (!(end > start))
+			return std::vector<HRoot>();
+
+		// Samples of [start, end), and end itself.
+		const size_t numSamples = util::getGridSize(start, end, step) + 1;
+		if (numSamples < 2)
+			return std::vector<HRoot>();
+
+		auto getX = [start, end, step, numSamples](size_t i) -> HReal
+		{
+			return i + 1 < numSamples ? start + static_cast<HReal>(i) * step : end;
+		};
+
+		std::vector<HReal> ys(numSamples);
+
+		forEachChunk(numSamples, ROOT_SCAN_CHUNK_SIZE, [&](size_t, size_t begin, size_t chunkEnd)
+			{
+				for (size_t i = begin; i < chunkEnd; ++i)
+				{
+					ys[i] = continuousFunc(getX(i));
+				}
+			});
+
+		// Brackets of sign changes, and ranges around local minima of |f| without a sign change.
+		struct Candidate final
+		{
+			HReal start;
+			HReal end;
+			bool bSignChange;
+		};
+
+		std::vector<Candidate> candidates;
+
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			const HReal x = getX(i);
+			const HReal error = std::abs(ys[i]);
+
+			if (error < epsilon)
+			{
+				candidates.push_back(Candidate{ x, x, true });
+				continue;
+			}
+
+			if (i + 1 < numSamples && std::abs(ys[i + 1]) >= epsilon && std::signbit(ys[i]) != std::signbit(ys[i + 1]))
+			{
+				candidates.push_back(Candidate{ x, getX(i + 1), true });
+				continue;
+			}
+
+			if (i == 0 || i + 1 == numSamples)
+				continue;
+
+			const bool bLocalMinimum = error < std::abs(ys[i - 1]) && error <= std::abs(ys[i + 1])
+				&& std::signbit(ys[i - 1]) == std::signbit(ys[i]) && std::signbit(ys[i]) == std::signbit(ys[i + 1]);
+
+			if (bLocalMinimum)
+			{
+				candidates.push_back(Candidate{ getX(i - 1), getX(i + 1), false });
+			}
+		}
+
+		std::vector<std::optional<HRoot>> refinedRoots(candidates.size());
+
+		forEachChunk(candidates.size(), 1, [&](size_t, size_t begin, size_t chunkEnd)
+			{
+				for (size_t i = begin; i < chunkEnd; ++i)
+				{
+					const Candidate& candidate = candidates[i];
+
+					if (candidate.start == candidate.end)
+					{
+						refinedRoots[i].emplace(candidate.start, std::abs(continuousFunc(candidate.start)));
+						continue;
+					}
+
+					if (candidate.bSignChange)
+					{
+						int count = 0;
+						const auto root = brentMethod(count, continuousFunc, candidate.start, candidate.end,
+							100, epsilon);
+
+						if (root)
+						{
+							refinedRoots[i].emplace(*root);
+						}
+
+						continue;
+					}
+
+					const HRoot minimum = minimizeAbs(continuousFunc, candidate.start, candidate.end);
+					if (minimum.error < epsilon)
+					{
+						refinedRoots[i].emplace(minimum);
+					}
+				}
+			});
+
+		// HRoot isn't assignable, so the roots are sorted by indices.
+		std::vector<size_t> order(refinedRoots.size());
+		std::iota(order.begin(), order.end(), 0);
+
+		order.erase(std::remove_if(order.begin(), order.end(), [&refinedRoots](size_t i) { return !refinedRoots[i]; }),
+			order.end());
+
+		std::sort(order.begin(), order.end(), [&refinedRoots](size_t lhs, size_t rhs)
+			{
+				return refinedRoots[lhs]->value < refinedRoots[rhs]->value;
+			});
+
+		// Merges roots closer than half a step, keeping the one of the smallest error.
+		std::vector<size_t> uniqueOrder;
+
+		for (size_t i : order)
+		{
+			if (!uniqueOrder.empty())
+			{
+				size_t& last = uniqueOrder.back();
+
+				if (refinedRoots[i]->value - refinedRoots[last]->value < HALF * step)
+				{
+					if (refinedRoots[i]->error < refinedRoots[last]->error)
+					{
+						last = i;
+					}
+
+					continue;
+				}
+			}
+
+			uniqueOrder.push_back(i);
+		}
+
+		std::vector<HRoot> roots;
+		roots.reserve(uniqueOrder.size());
+
+		for (size_t i : uniqueOrder)
+		{
+			roots.push_back(*refinedRoots[i]);
+		}
+
+		return roots;
+	}
+} // anonymous
+
+std::vector<HRoot> findAllRoots(FunctionRef continuousFunc, HReal start, HReal end, HReal step, HReal epsilon)
+{
+	return findAllRootsOn(nullptr, continuousFunc, start, end, step, epsilon);
+}
+
+std::vector<HRoot> findAllRoots(ThreadPool& pool, FunctionRef continuousFunc, HReal start, HReal end,
+	HReal step, HReal epsilon)
+{
+	return findAllRootsOn(&pool, continuousFunc, start, end, step, epsilon);
+}
+
 HReal getError(HReal approximateValue, HReal trueValue)
 {
-	return abs(approximateValue - trueValue);
+	return std::abs(approximateValue - trueValue);
 }
 
 HReal getRelativeError(HReal approximateValue, HReal trueValue)
 {
-	auto diff = abs(approximateValue - trueValue);
+	auto diff = std::abs(approximateValue - trueValue);
 	if (diff < MIN_NUMBER)
 		return ZERO;
 
-	if (abs(trueValue) < SMALL_NUMBER)
+	if (std::abs(trueValue) < SMALL_NUMBER)
 		return MAX_NUMBER;
 
 	return diff / trueValue;
@@ -510,7 +922,7 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 				<< ", true value = " << trueValue
 				<< ", error = " << errorValue << endl;
 					
-			if (abs(errorValue) > MAX_ERROR)
+			if (std::abs(errorValue) > MAX_ERROR)
 			{
 				++errorCount;
 
@@ -537,7 +949,7 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 				<< ", true value = " << trueValue
 				<< ", error = " << errorValue << endl;
 
-			if (abs(errorValue) > MAX_ERROR)
+			if (std::abs(errorValue) > MAX_ERROR)
 			{
 				++errorCount;
 
@@ -556,6 +968,53 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 		}
 	}
 
+	{
+		cout << endl << "[Analysis][TC" << ++inOutTestCount
+			<< "] Derivative tests by automatic differentiation" << endl;
+
+		auto func = [](auto x) { return sin(x) * exp(x * HALF); };
+
+		auto dyFunc = [func](HReal value) -> HReal { return autodiff::derivative(func, value); };
+		auto ddyFunc = autodiff::getSecondOrderDerivative(func);
+
+		auto trueDyFunc = [](HReal x) -> HReal
+		{
+			return (cos(x) + HALF * sin(x)) * exp(x * HALF);
+		};
+
+		auto trueDdyFunc = [](HReal x) -> HReal
+		{
+			return (cos(x) - 0.75 * sin(x)) * exp(x * HALF);
+		};
+
+		auto error = util::compare(dyFunc, trueDyFunc, -TWO_PI, TWO_PI, TWO_PI * 0.001);
+		auto error2 = util::compare(ddyFunc, trueDdyFunc, -TWO_PI, TWO_PI, TWO_PI * 0.001);
+
+		// Generic callables of std functions still take the finite differences.
+		auto error3 = getError(derivative([](auto x) { return std::sin(x); }, ONE), std::cos(ONE));
+
+		cout << "[Analysis][TC" << inOutTestCount
+			<< "] Dual number derivative: error = " << error
+			<< ", hyper-dual 2nd. order derivative: error = " << error2
+			<< ", finite difference: error = " << error3 << endl;
+
+		if (error > NANO || error2 > NANO || error3 > SMALL_NUMBER)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[Analysis][TC" << inOutTestCount
+				<< "][Error] " << __LINE__ << ": "
+				<< error << ", " << error2 << ", " << error3 << " is huge than expect "
+				<< NANO << ", " << NANO << ", " << SMALL_NUMBER << endl << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
 	{
 		++inOutTestCount;
 
@@ -577,7 +1036,7 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 				<< ", count = " << iterationCount << endl;
 
 			auto value = func(root->value);
-			if (abs(func(root->value)) > SMALL_NUMBER)
+			if (std::abs(func(root->value)) > SMALL_NUMBER)
 			{
 				++errorCount;
 
@@ -637,7 +1096,7 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 				<< ", count = " << iterationCount << endl;
 
 			auto value = func(root->value);
-			if (abs(func(root->value)) > SMALL_NUMBER)
+			if (std::abs(func(root->value)) > SMALL_NUMBER)
 			{
 				++errorCount;
 
@@ -693,7 +1152,7 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 				<< ", count = " << iterationCount << endl;
 
 			auto value = func(root->value);
-			if (abs(func(root->value)) > SMALL_NUMBER)
+			if (std::abs(func(root->value)) > SMALL_NUMBER)
 			{
 				++errorCount;
 
@@ -725,6 +1184,45 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 		}
 	}
 
+	{
+		++inOutTestCount;
+
+		cout << endl << "[Analysis][TC" << inOutTestCount
+			<< "] Solver: Newton-Raphson Method (Dual number)" << endl;
+
+		int numEvaluations = 0;
+		auto func = [&numEvaluations](auto x)
+		{
+			++numEvaluations;
+			return 2 * x * x * x + 1;
+		};
+
+		int iterationCount = 0;
+		auto root = autodiff::newtonRaphsonMethod(iterationCount, func, -10);
+
+		if (root && std::abs(2 * root->value * root->value * root->value + 1) <= SMALL_NUMBER)
+		{
+			cout << "[Analysis][TC" << inOutTestCount
+				<< "] root = " << root->value << ", error = " << root->error
+				<< ", count = " << iterationCount << ", evaluations = " << numEvaluations << endl;
+		}
+		else
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[Analysis][TC" << inOutTestCount
+				<< "][Error] " << __LINE__
+				<< ": failed to find a root with "
+				<< iterationCount << " try." << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
 	{
 		++inOutTestCount;
 
@@ -746,7 +1244,7 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 				<< ", count = " << iterationCount << endl;
 
 			auto value = func(root->value);
-			if (abs(func(root->value)) > SMALL_NUMBER)
+			if (std::abs(func(root->value)) > SMALL_NUMBER)
 			{
 				++errorCount;
 
@@ -779,6 +1277,171 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 		}
 	}
 
+	{
+		++inOutTestCount;
+
+		cout << endl << "[Analysis][TC" << inOutTestCount
+			<< "] Solver: Brent and ITP methods against bisection, Newton-Raphson and secant" << endl;
+
+		struct Equation final
+		{
+			const char* name;
+			TFunc1 func;
+			HReal start;
+			HReal end;
+		};
+
+		const Equation equations[] =
+		{
+			{ "x^3 - 2x - 5", [](HReal x) { return x * x * x - 2 * x - 5; }, 2, 3 },
+			{ "cos(x) - x", [](HReal x) { return std::cos(x) - x; }, 0, 1 },
+			{ "exp(x) - 10", [](HReal x) { return std::exp(x) - 10; }, 0, 4 },
+			{ "x^10 - 1", [](HReal x) { return std::pow(x, 10) - 1; }, 0, 1.3 },
+			{ "atan(x - 1)", [](HReal x) { return std::atan(x - 1); }, -4, 5 },
+			{ "(x - 1)^3 - 0.001", [](HReal x) { return (x - 1) * (x - 1) * (x - 1) - 0.001; }, -3, 4 },
+			{ "x exp(-x) - 0.1", [](HReal x) { return x * std::exp(-x) - 0.1; }, -1, 1 },
+			{ "1 / (x - 0.1) + 2", [](HReal x) { return ONE / (x - 0.1) + 2; }, -1, 0 }
+		};
+
+		using TSolver = std::optional<HRoot>(*)(int&, FunctionRef, HReal, HReal);
+
+		struct Method final
+		{
+			const char* name;
+			TSolver solve;
+			int minSolved;
+		};
+
+		// Bisection stops once the bracket is narrower than epsilon, where exp(x) - 10 is still about 10 epsilon.
+		// The secant steps from [0, 1.3] fall into the flat part of x^10 - 1 near zero and diverge.
+		const int numEquations = static_cast<int>(std::size(equations));
+		const Method methods[] =
+		{
+			{ "Bisection", [](int& count, FunctionRef f, HReal a, HReal b) { return bisectionMethod(count, f, a, b); }, numEquations - 1 },
+			{ "Newton-Raphson", [](int& count, FunctionRef f, HReal a, HReal b) { return newtonRaphsonMethod(count, f, HALF * (a + b)); }, numEquations },
+			{ "Secant", [](int& count, FunctionRef f, HReal a, HReal b) { return secantMethod(count, f, a, b); }, numEquations - 1 },
+			{ "Brent", [](int& count, FunctionRef f, HReal a, HReal b) { return brentMethod(count, f, a, b); }, numEquations },
+			{ "ITP", [](int& count, FunctionRef f, HReal a, HReal b) { return itpMethod(count, f, a, b); }, numEquations }
+		};
+
+		int bisectionEvaluations = 0;
+
+		for (size_t m = 0; m < std::size(methods); ++m)
+		{
+			const auto& method = methods[m];
+
+			int numEvaluations = 0;
+			int numSolved = 0;
+
+			for (const auto& equation : equations)
+			{
+				auto countedFunc = [&equation, &numEvaluations](HReal x) -> HReal
+				{
+					++numEvaluations;
+					return equation.func(x);
+				};
+
+				int iterationCount = 0;
+				const auto root = method.solve(iterationCount, countedFunc, equation.start, equation.end);
+
+				if (root && std::abs(equation.func(root->value)) < SMALL_NUMBER)
+				{
+					++numSolved;
+				}
+			}
+
+			cout << "[Analysis][TC" << inOutTestCount << "] " << method.name << ": solved " << numSolved
+				<< " of " << std::size(equations) << " with " << numEvaluations << " evaluations" << endl;
+
+			if (m == 0)
+			{
+				bisectionEvaluations = numEvaluations;
+			}
+
+			// Brent and ITP should solve every equation with fewer evaluations than bisection.
+			const bool bHybrid = m >= 3;
+			if (numSolved < method.minSolved || (bHybrid && numEvaluations >= bisectionEvaluations))
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[Analysis][TC" << inOutTestCount
+					<< "][Error] " << __LINE__ << ": " << method.name << " solved " << numSolved
+					<< " of at least " << method.minSolved << " with " << numEvaluations << " evaluations, bisection took "
+					<< bisectionEvaluations << endl;
+
+				const auto errorMsg = msg.view();
+				cerr << errorMsg;
+
+				outErrorMessages.emplace_back(errorMsg);
+			}
+		}
+	}
+
+	{
+		++inOutTestCount;
+
+		cout << endl << "[Analysis][TC" << inOutTestCount << "] Solver: Find all roots" << endl;
+
+		struct Case final
+		{
+			const char* name;
+			TFunc1 func;
+			HReal start;
+			HReal end;
+			std::vector<HReal> trueRoots;
+		};
+
+		const HReal pi = std::acos(MINUS_ONE);
+
+		const Case cases[] =
+		{
+			{ "sin(x)", [](HReal x) { return std::sin(x); }, -10, 10, { -3 * pi, -2 * pi, -pi, 0, pi, 2 * pi, 3 * pi } },
+			{ "(x - 1)^2 (x + 2)", [](HReal x) { return (x - 1) * (x - 1) * (x + 2); }, -5, 5, { -2, 1 } },
+			{ "cos(x) + 2", [](HReal x) { return std::cos(x) + 2; }, -10, 10, {} },
+			{ "x^2 - 4 on the end points", [](HReal x) { return x * x - 4; }, -2, 2, { -2, 2 } }
+		};
+
+		ThreadPool parallel(4);
+
+		for (const auto& testCase : cases)
+		{
+			// Without a pool, the scan runs on the calling thread.
+			const auto roots = findAllRoots(parallel, testCase.func, testCase.start, testCase.end, 0.1);
+			const auto serialRoots = findAllRoots(testCase.func, testCase.start, testCase.end, 0.1);
+
+			bool bPassed = roots.size() == testCase.trueRoots.size() && serialRoots.size() == roots.size();
+
+			cout << "[Analysis][TC" << inOutTestCount << "] " << testCase.name << ":";
+
+			for (size_t i = 0; i < roots.size(); ++i)
+			{
+				cout << " " << roots[i].value;
+
+				bPassed = bPassed && i < testCase.trueRoots.size()
+					&& std::abs(roots[i].value - testCase.trueRoots[i]) < 0.01
+					&& roots[i].value == serialRoots[i].value;
+			}
+
+			cout << endl;
+
+			if (!bPassed)
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[Analysis][TC" << inOutTestCount
+					<< "][Error] " << __LINE__ << ": found " << roots.size() << " roots of " << testCase.name
+					<< ", expected " << testCase.trueRoots.size() << endl;
+
+				const auto errorMsg = msg.view();
+				cerr << errorMsg;
+
+				outErrorMessages.emplace_back(errorMsg);
+			}
+		}
+	}
+
 	return errorCount;
 }
 #endif // DO_TEST
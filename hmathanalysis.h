@@ -2,6 +2,8 @@
 
 #include "hmathconfig.h"
 #include "hmathconstants.h"
+#include "hmathfunctionref.h"
+#include "hmaththreadpool.h"
 #include "hmathtypes.h"
 
 #include <optional>
@@ -15,13 +17,16 @@ namespace analysis
 {
 	static constexpr HReal DERIVATIVE_STEP = 1e-4;
 
-	HReal derivativeFromBelow(const TFunc1& func, HReal x, HReal epsilon = DERIVATIVE_STEP);
-	HReal derivativeFromAbove(const TFunc1& func, HReal x, HReal epsilon = DERIVATIVE_STEP);
-	HReal derivative(const TFunc1& func, HReal x, HReal epsilon = DERIVATIVE_STEP);
+	// Functions only calling the given function take a FunctionRef, so that lambdas are passed
+	// without being copied into a TFunc1. The ones returning a function keep a copy in TFunc1.
 
-	HReal secondOrderDerivativeFromBelow(const TFunc1& func, HReal x, HReal epsilon = DERIVATIVE_STEP);
-	HReal secondOrderDerivativeFromAbove(const TFunc1& func, HReal x, HReal epsilon = DERIVATIVE_STEP);
-	HReal secondOrderDerivative(const TFunc1& func, HReal x, HReal epsilon = DERIVATIVE_STEP);
+	HReal derivativeFromBelow(FunctionRef func, HReal x, HReal epsilon = DERIVATIVE_STEP);
+	HReal derivativeFromAbove(FunctionRef func, HReal x, HReal epsilon = DERIVATIVE_STEP);
+	HReal derivative(FunctionRef func, HReal x, HReal epsilon = DERIVATIVE_STEP);
+
+	HReal secondOrderDerivativeFromBelow(FunctionRef func, HReal x, HReal epsilon = DERIVATIVE_STEP);
+	HReal secondOrderDerivativeFromAbove(FunctionRef func, HReal x, HReal epsilon = DERIVATIVE_STEP);
+	HReal secondOrderDerivative(FunctionRef func, HReal x, HReal epsilon = DERIVATIVE_STEP);
 
 	TFunc1 getDerivativeFromBelow(const TFunc1& func, HReal epsilon = DERIVATIVE_STEP);
 	TFunc1 getDerivativeFromAbove(const TFunc1& func, HReal epsilon = DERIVATIVE_STEP);
@@ -31,6 +36,10 @@ namespace analysis
 	TFunc1 getSecondOrderDerivativeFromAbove(const TFunc1& func, HReal epsilon = DERIVATIVE_STEP);
 	TFunc1 getSecondOrderDerivative(const TFunc1& func, HReal epsilon = DERIVATIVE_STEP);
 
+	// Exact derivatives of generic callables by automatic differentiation are autodiff::derivative,
+	// autodiff::secondOrderDerivative and autodiff::newtonRaphsonMethod, named apart from these
+	// so that overload resolution never evaluates callers' lambdas on dual numbers.
+
 	HReal getError(HReal approximateValue, HReal trueValue);
 	HReal getRelativeError(HReal approximateValue, HReal trueValue);
 
@@ -39,27 +48,58 @@ namespace analysis
 	// The sign of f(start) and f(end) should be different.
 	// If f(start) is positive, then f(end) should be negative.
 	std::optional<HRoot> bisectionMethod(int& outIterationCount,
-		const TFunc1& continuousFunc, HReal start, HReal end,
+		FunctionRef continuousFunc, HReal start, HReal end,
 		int maxCount = 30, HReal epsilon = SMALL_NUMBER);
 
 	// conditions
 	// The given function should be differentiable for every point.
 	// y`(start) should not be zero.
 	std::optional<HRoot> newtonRaphsonMethod(int& outIterationCount,
-		const TFunc1& func, const TFunc1& derivativeFunc, HReal start,
+		FunctionRef func, FunctionRef derivativeFunc, HReal start,
 		int maxCount = 30, HReal epsilon = SMALL_NUMBER);
 
 	std::optional<HRoot> newtonRaphsonMethod(int& outIterationCount,
-		const TFunc1& differentiableFunc, HReal start,
+		FunctionRef differentiableFunc, HReal start,
 		int maxCount = 30, HReal epsilon = SMALL_NUMBER);
 
 	// conditions
 	// The given function should be differentiable for every point.
 	// y`(start) should not be zero.
 	std::optional<HRoot> secantMethod(int& outIterationCount,
-		const TFunc1& differentiableFunc, HReal start, HReal start2,
+		FunctionRef differentiableFunc, HReal start, HReal start2,
 		int maxCount = 30, HReal epsilon = SMALL_NUMBER);
 
+	// Bracketed hybrid solvers, converging superlinearly on smooth functions
+	// while keeping the bracket of bisection, so that they never diverge.
+	// conditions
+	// The given function should be continous on range [start, end].
+	// The sign of f(start) and f(end) should be different.
+
+	// Brent-Dekker method, taking inverse quadratic interpolation, secant or bisection steps.
+	std::optional<HRoot> brentMethod(int& outIterationCount,
+		FunctionRef continuousFunc, HReal start, HReal end,
+		int maxCount = 100, HReal epsilon = SMALL_NUMBER);
+
+	// ITP (Interpolate, Truncate and Project) method of Oliveira and Takahashi,
+	// which takes no more iterations than bisection in the worst case.
+	std::optional<HRoot> itpMethod(int& outIterationCount,
+		FunctionRef continuousFunc, HReal start, HReal end,
+		int maxCount = 100, HReal epsilon = SMALL_NUMBER);
+
+	static constexpr size_t ROOT_SCAN_CHUNK_SIZE = 4096;
+
+	// Finds every root on [start, end] in ascending order.
+	// The function is sampled on the grid start + i * step, and each sign change
+	// is refined by brentMethod, while each local minimum of |f| without a sign change,
+	// e.g. a double root, is refined by a golden-section search and kept if |f| < epsilon.
+	// Given a pool, the sampling and the refinements run in parallel on it, so the function should be safe
+	// to call concurrently; otherwise they run serially on the calling thread.
+	// Roots closer than half a step are merged. Roots closer than a step may be missed.
+	std::vector<HRoot> findAllRoots(FunctionRef continuousFunc, HReal start, HReal end, HReal step,
+		HReal epsilon = SMALL_NUMBER);
+	std::vector<HRoot> findAllRoots(ThreadPool& pool, FunctionRef continuousFunc, HReal start, HReal end,
+		HReal step, HReal epsilon = SMALL_NUMBER);
+
 #if DO_TEST
 	int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
 #endif // DO_TEST
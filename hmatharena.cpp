@@ -0,0 +1,63 @@
+#include "hmatharena.h"
+
+#include <algorithm>
+
+
+namespace hmath
+{
+	Arena::Arena(size_t inBlockSize)
+		: blockIndex(0), offset(0), blockSize(std::max<size_t>(inBlockSize, 1))
+	{
+	}
+
+	void Arena::reset()
+	{
+		blockIndex = 0;
+		offset = 0;
+	}
+
+	void Arena::release()
+	{
+		std::vector<Block>().swap(blocks);
+		reset();
+	}
+
+	size_t Arena::getNumBlocks() const
+	{
+		return blocks.size();
+	}
+
+	size_t Arena::getCapacity() const
+	{
+		size_t capacity = 0;
+		for (auto& block : blocks)
+		{
+			capacity += block.size;
+		}
+
+		return capacity;
+	}
+
+	void* Arena::allocateFromNextBlock(size_t size, size_t alignment)
+	{
+		const size_t requiredSize = size + alignment;
+
+		// Reuses the blocks kept from the previous round first.
+		while (++blockIndex < blocks.size())
+		{
+			if (blocks[blockIndex].size >= requiredSize)
+			{
+				offset = 0;
+				return allocate(size, alignment);
+			}
+		}
+
+		const size_t newBlockSize = std::max(blockSize, requiredSize);
+		blocks.push_back(Block{ std::unique_ptr<std::byte[]>(new std::byte[newBlockSize]), newBlockSize });
+
+		blockIndex = blocks.size() - 1;
+		offset = 0;
+
+		return allocate(size, alignment);
+	}
+} // hmath
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace hmath
+{
+	// Bump allocator handing out memory from a list of blocks.
+	// Nothing is freed individually, reset() rewinds every block at once and keeps them for reuse,
+	// so a workload of the same size allocates nothing after the first round.
+	class Arena final
+	{
+	public:
+		static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	private:
+		struct Block final
+		{
+			std::unique_ptr<std::byte[]> memory;
+			size_t size;
+		};
+
+		std::vector<Block> blocks;
+		size_t blockIndex;
+		size_t offset;
+		size_t blockSize;
+
+	public:
+		explicit Arena(size_t inBlockSize = DEFAULT_BLOCK_SIZE);
+		Arena(const Arena&) = delete;
+		Arena(Arena&&) = default;
+		~Arena() = default;
+
+		Arena& operator= (const Arena&) = delete;
+		Arena& operator= (Arena&&) = default;
+
+		void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+		{
+			assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+			if (blockIndex < blocks.size())
+			{
+				auto& block = blocks[blockIndex];
+				const auto address = reinterpret_cast<uintptr_t>(block.memory.get() + offset);
+				const size_t alignedOffset = offset + (((address + alignment - 1) & ~(alignment - 1)) - address);
+
+				if (alignedOffset + size <= block.size)
+				{
+					offset = alignedOffset + size;
+					return block.memory.get() + alignedOffset;
+				}
+			}
+
+			return allocateFromNextBlock(size, alignment);
+		}
+
+		// Objects are never destroyed, so only trivially destructible types are allowed.
+		template <typename T, typename... TArgs>
+		T* create(TArgs&&... args)
+		{
+			static_assert(std::is_trivially_destructible<T>::value);
+
+			void* memory = allocate(sizeof(T), alignof(T));
+			return new (memory) T{ std::forward<TArgs>(args)... };
+		}
+
+		void reset();
+		void release();
+
+		size_t getNumBlocks() const;
+		size_t getCapacity() const;
+
+	private:
+		void* allocateFromNextBlock(size_t size, size_t alignment);
+	};
+} // hmath
@@ -0,0 +1,627 @@
+#include "hmathautodiff.h"
+
+#include "hmathanalysis.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+
+namespace hmath
+{
+namespace autodiff
+{
+
+TaylorNumber::TaylorNumber(HReal constant, int depth)
+	: coefficients(static_cast<size_t>(std::max(depth, 1)), ZERO)
+{
+	coefficients[0] = constant;
+}
+
+TaylorNumber TaylorNumber::variable(HReal point, int depth)
+{
+	TaylorNumber x(point, depth);
+	if (x.getDepth() > 1)
+	{
+		x.coefficients[1] = ONE;
+	}
+
+	return x;
+}
+
+TaylorNumber TaylorNumber::operator- () const
+{
+	TaylorNumber outcome(*this);
+	for (auto& coeff : outcome.coefficients)
+	{
+		coeff = -coeff;
+	}
+
+	return outcome;
+}
+
+TaylorNumber TaylorNumber::operator+ (const TaylorNumber& rhs) const
+{
+	assert(getDepth() == rhs.getDepth());
+
+	TaylorNumber outcome(*this);
+	const int depth = std::min(getDepth(), rhs.getDepth());
+
+	for (int i = 0; i < depth; ++i)
+	{
+		outcome.coefficients[i] += rhs.coefficients[i];
+	}
+
+	return outcome;
+}
+
+TaylorNumber TaylorNumber::operator- (const TaylorNumber& rhs) const
+{
+	assert(getDepth() == rhs.getDepth());
+
+	TaylorNumber outcome(*this);
+	const int depth = std::min(getDepth(), rhs.getDepth());
+
+	for (int i = 0; i < depth; ++i)
+	{
+		outcome.coefficients[i] -= rhs.coefficients[i];
+	}
+
+	return outcome;
+}
+
+TaylorNumber TaylorNumber::operator* (const TaylorNumber& rhs) const
+{
+	assert(getDepth() == rhs.getDepth());
+
+	const int depth = std::min(getDepth(), rhs.getDepth());
+	TaylorNumber outcome(ZERO, depth);
+
+	// Cauchy product, truncated at depth
+	for (int k = 0; k < depth; ++k)
+	{
+		HReal sum = ZERO;
+		for (int j = 0; j <= k; ++j)
+		{
+			sum += coefficients[j] * rhs.coefficients[k - j];
+		}
+
+		outcome.coefficients[k] = sum;
+	}
+
+	return outcome;
+}
+
+TaylorNumber TaylorNumber::operator/ (const TaylorNumber& rhs) const
+{
+	assert(getDepth() == rhs.getDepth());
+
+	const int depth = std::min(getDepth(), rhs.getDepth());
+	TaylorNumber outcome(ZERO, depth);
+
+	// c = a / b  <=>  c_k = (a_k - sum_{j=1..k} b_j c_{k-j}) / b_0
+	const HReal divisor = rhs.coefficients[0];
+	for (int k = 0; k < depth; ++k)
+	{
+		HReal sum = coefficients[k];
+		for (int j = 1; j <= k; ++j)
+		{
+			sum -= rhs.coefficients[j] * outcome.coefficients[k - j];
+		}
+
+		outcome.coefficients[k] = sum / divisor;
+	}
+
+	return outcome;
+}
+
+TaylorNumber TaylorNumber::operator+ (HReal rhs) const
+{
+	TaylorNumber outcome(*this);
+	outcome.coefficients[0] += rhs;
+
+	return outcome;
+}
+
+TaylorNumber TaylorNumber::operator- (HReal rhs) const
+{
+	TaylorNumber outcome(*this);
+	outcome.coefficients[0] -= rhs;
+
+	return outcome;
+}
+
+TaylorNumber TaylorNumber::operator* (HReal rhs) const
+{
+	TaylorNumber outcome(*this);
+	for (auto& coeff : outcome.coefficients)
+	{
+		coeff *= rhs;
+	}
+
+	return outcome;
+}
+
+TaylorNumber TaylorNumber::operator/ (HReal rhs) const
+{
+	return *this * (ONE / rhs);
+}
+
+TaylorNumber operator+ (HReal lhs, const TaylorNumber& rhs)
+{
+	return rhs + lhs;
+}
+
+TaylorNumber operator- (HReal lhs, const TaylorNumber& rhs)
+{
+	return (-rhs) + lhs;
+}
+
+TaylorNumber operator* (HReal lhs, const TaylorNumber& rhs)
+{
+	return rhs * lhs;
+}
+
+TaylorNumber operator/ (HReal lhs, const TaylorNumber& rhs)
+{
+	return TaylorNumber(lhs, rhs.getDepth()) / rhs;
+}
+
+std::ostream& operator<< (std::ostream& stream, const TaylorNumber& number)
+{
+	stream << '[';
+
+	const int depth = number.getDepth();
+	for (int i = 0; i < depth; ++i)
+	{
+		stream << (i == 0 ? "" : ", ") << number.coefficients[i];
+	}
+
+	stream << ']';
+
+	return stream;
+}
+
+int TaylorNumber::getDepth() const
+{
+	return static_cast<int>(coefficients.size());
+}
+
+HReal TaylorNumber::getValue() const
+{
+	return getCoefficient(0);
+}
+
+HReal TaylorNumber::getCoefficient(int index) const
+{
+	if (index < 0 || index >= getDepth())
+		return ZERO;
+
+	return coefficients[index];
+}
+
+HReal TaylorNumber::getDerivative(int order) const
+{
+	HReal factorial = ONE;
+	for (int i = 2; i <= order; ++i)
+	{
+		factorial *= i;
+	}
+
+	return getCoefficient(order) * factorial;
+}
+
+std::span<const HReal> TaylorNumber::getCoefficients() const
+{
+	return std::span<const HReal>(coefficients.data(), coefficients.size());
+}
+
+TaylorNumber exp(const TaylorNumber& x)
+{
+	const int depth = x.getDepth();
+	TaylorNumber outcome(std::exp(x.coefficients[0]), depth);
+
+	// e' = x' e  =>  e_k = (1/k) sum_{j=1..k} j x_j e_{k-j}
+	for (int k = 1; k < depth; ++k)
+	{
+		HReal sum = ZERO;
+		for (int j = 1; j <= k; ++j)
+		{
+			sum += j * x.coefficients[j] * outcome.coefficients[k - j];
+		}
+
+		outcome.coefficients[k] = sum / k;
+	}
+
+	return outcome;
+}
+
+TaylorNumber log(const TaylorNumber& x)
+{
+	const int depth = x.getDepth();
+	const HReal x0 = x.coefficients[0];
+	TaylorNumber outcome(std::log(x0), depth);
+
+	// x l' = x'  =>  l_k = (x_k - (1/k) sum_{j=1..k-1} j l_j x_{k-j}) / x_0
+	for (int k = 1; k < depth; ++k)
+	{
+		HReal sum = ZERO;
+		for (int j = 1; j < k; ++j)
+		{
+			sum += j * outcome.coefficients[j] * x.coefficients[k - j];
+		}
+
+		outcome.coefficients[k] = (x.coefficients[k] - sum / k) / x0;
+	}
+
+	return outcome;
+}
+
+TaylorNumber sqrt(const TaylorNumber& x)
+{
+	const int depth = x.getDepth();
+	const HReal root = std::sqrt(x.coefficients[0]);
+	TaylorNumber outcome(root, depth);
+
+	// r * r = x  =>  r_k = (x_k - sum_{j=1..k-1} r_j r_{k-j}) / (2 r_0)
+	for (int k = 1; k < depth; ++k)
+	{
+		HReal sum = x.coefficients[k];
+		for (int j = 1; j < k; ++j)
+		{
+			sum -= outcome.coefficients[j] * outcome.coefficients[k - j];
+		}
+
+		outcome.coefficients[k] = sum / (TWO * root);
+	}
+
+	return outcome;
+}
+
+void TaylorNumber::sinCos(const TaylorNumber& x, TaylorNumber& outSin, TaylorNumber& outCos)
+{
+	const int depth = x.getDepth();
+	outSin = TaylorNumber(std::sin(x.coefficients[0]), depth);
+	outCos = TaylorNumber(std::cos(x.coefficients[0]), depth);
+
+	// s' = x' c, c' = -x' s
+	for (int k = 1; k < depth; ++k)
+	{
+		HReal sinSum = ZERO;
+		HReal cosSum = ZERO;
+
+		for (int j = 1; j <= k; ++j)
+		{
+			const HReal dx = j * x.coefficients[j];
+			sinSum += dx * outCos.coefficients[k - j];
+			cosSum -= dx * outSin.coefficients[k - j];
+		}
+
+		outSin.coefficients[k] = sinSum / k;
+		outCos.coefficients[k] = cosSum / k;
+	}
+}
+
+TaylorNumber sin(const TaylorNumber& x)
+{
+	TaylorNumber sinValue;
+	TaylorNumber cosValue;
+	TaylorNumber::sinCos(x, sinValue, cosValue);
+
+	return sinValue;
+}
+
+TaylorNumber cos(const TaylorNumber& x)
+{
+	TaylorNumber sinValue;
+	TaylorNumber cosValue;
+	TaylorNumber::sinCos(x, sinValue, cosValue);
+
+	return cosValue;
+}
+
+TaylorNumber tan(const TaylorNumber& x)
+{
+	TaylorNumber sinValue;
+	TaylorNumber cosValue;
+	TaylorNumber::sinCos(x, sinValue, cosValue);
+
+	return sinValue / cosValue;
+}
+
+TaylorNumber pow(const TaylorNumber& x, HReal exponent)
+{
+	const int depth = x.getDepth();
+	const HReal x0 = x.coefficients[0];
+
+	// The recurrence below divides by x_0.
+	if (x0 == ZERO)
+	{
+		// Integral powers are exact products.
+		if (std::trunc(exponent) == exponent && std::abs(exponent) <= std::numeric_limits<int>::max())
+			return pow(x, static_cast<int>(exponent));
+
+		TaylorNumber outcome(std::pow(ZERO, exponent), depth);
+
+		int order = 1;
+		while (order < depth && x.coefficients[order] == ZERO)
+		{
+			++order;
+		}
+
+		// x is zero up to the depth.
+		if (order == depth)
+			return outcome;
+
+		// x = t^m y with y_0 = x_m != 0, so x^a = t^(m a) y^a.
+		const HReal power = order * exponent;
+
+		if (power > ZERO && std::trunc(power) == power)
+		{
+			// y^a is regular, and its terms past depth - m depend on terms of x past the depth.
+			TaylorNumber y(ZERO, depth - order);
+			for (int k = order; k < depth; ++k)
+			{
+				y.coefficients[k - order] = x.coefficients[k];
+			}
+
+			const TaylorNumber powY = pow(y, exponent);
+			const int shift = static_cast<int>(power);
+
+			for (int k = 1; k < depth; ++k)
+			{
+				const int index = k - shift;
+				outcome.coefficients[k] = index < 0 ? ZERO : (index < depth - order ? powY.coefficients[index] : NAN);
+			}
+
+			return outcome;
+		}
+
+		// Otherwise the terms below t^(m a) vanish, and the ones above are infinite,
+		// of the sign of the leading term x_m^a C(m a, k) t^(m a - k), or NaN if x_m^a is.
+		const HReal leading = std::pow(x.coefficients[order], exponent);
+
+		HReal binomial = ONE;
+		for (int k = 1; k < depth; ++k)
+		{
+			binomial *= (power - (k - 1)) / k;
+			outcome.coefficients[k] = binomial * leading * std::pow(ZERO, power - k);
+		}
+
+		return outcome;
+	}
+
+	TaylorNumber outcome(std::pow(x0, exponent), depth);
+
+	// x p' = a x' p  =>  p_k = (1 / (k x_0)) sum_{j=1..k} (a j - (k - j)) x_j p_{k-j}
+	for (int k = 1; k < depth; ++k)
+	{
+		HReal sum = ZERO;
+		for (int j = 1; j <= k; ++j)
+		{
+			sum += (exponent * j - (k - j)) * x.coefficients[j] * outcome.coefficients[k - j];
+		}
+
+		outcome.coefficients[k] = sum / (k * x0);
+	}
+
+	return outcome;
+}
+
+TaylorNumber pow(const TaylorNumber& x, int exponent)
+{
+	if (exponent < 0)
+		return ONE / pow(x, -exponent);
+
+	// Exponentiation by squaring
+	TaylorNumber outcome(ONE, x.getDepth());
+	TaylorNumber base(x);
+
+	while (exponent > 0)
+	{
+		if ((exponent & 1) != 0)
+		{
+			outcome = outcome * base;
+		}
+
+		exponent >>= 1;
+		if (exponent > 0)
+		{
+			base = base * base;
+		}
+	}
+
+	return outcome;
+}
+
+#if DO_TEST
+int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
+{
+	using namespace std;
+
+	int errorCount = 0;
+
+	{
+		cout << endl << "[AutoDiff][TC" << ++inOutTestCount
+			<< "] Taylor arithmetic identities" << endl;
+
+		constexpr int depth = 10;
+		const auto x = TaylorNumber::variable(0.7, depth);
+
+		const auto sinValue = sin(x);
+		const auto cosValue = cos(x);
+
+		const TaylorNumber identities[] = {
+			sinValue * sinValue + cosValue * cosValue - ONE,
+			log(exp(x)) - x,
+			sqrt(x) * sqrt(x) - x,
+			pow(x, 2.5) - x * x * sqrt(x),
+			pow(x, 3) - x * x * x,
+			tan(x) - sinValue / cosValue,
+			(ONE / x) * x - ONE };
+
+		HReal error = ZERO;
+		for (const auto& identity : identities)
+		{
+			for (int i = 0; i < depth; ++i)
+			{
+				error = max(error, analysis::getError(identity.getCoefficient(i), ZERO));
+			}
+		}
+
+		cout << "[AutoDiff][TC" << inOutTestCount
+			<< "] Identity check: error = " << error << endl;
+
+		if (error > EPSILON)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[AutoDiff][TC" << inOutTestCount
+				<< "][Error] " << __LINE__ << ": "
+				<< error << " is huge than expect "
+				<< EPSILON << endl << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	{
+		cout << endl << "[AutoDiff][TC" << ++inOutTestCount
+			<< "] Higher order derivatives of exp(sin(x))" << endl;
+
+		constexpr HReal point = 0.3;
+		const auto y = exp(sin(TaylorNumber::variable(point, 4)));
+
+		// (e^sin)' = cos e^sin, (e^sin)'' = (cos^2 - sin) e^sin, (e^sin)''' = cos (cos^2 - 3 sin - 1) e^sin
+		const HReal s = std::sin(point);
+		const HReal c = std::cos(point);
+		const HReal e = std::exp(s);
+		const HReal trueValues[] = { e, c * e, (c * c - s) * e, c * (c * c - 3 * s - 1) * e };
+
+		HReal error = ZERO;
+		for (int i = 0; i < 4; ++i)
+		{
+			const HReal value = y.getDerivative(i);
+			error = max(error, analysis::getError(value, trueValues[i]));
+
+			cout << "[AutoDiff][TC" << inOutTestCount << "] f^(" << i << ")(" << point
+				<< ") = " << value << ", true value = " << trueValues[i] << endl;
+		}
+
+		if (error > EPSILON)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[AutoDiff][TC" << inOutTestCount
+				<< "][Error] " << __LINE__ << ": "
+				<< error << " is huge than expect "
+				<< EPSILON << endl << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	{
+		cout << endl << "[AutoDiff][TC" << ++inOutTestCount
+			<< "] Taylor expansion of powers at zero" << endl;
+
+		constexpr int depth = 5;
+		const auto x = TaylorNumber::variable(ZERO, depth);
+
+		const auto square = pow(x, 2.0);
+		const auto squareRoot = pow(x, 0.5);
+		const auto cubeRootOfCube = pow(x * x * x, ONE / 3);
+
+		cout << "[AutoDiff][TC" << inOutTestCount << "] x^2 = " << square << ", x^0.5 = " << squareRoot
+			<< ", (x^3)^(1/3) = " << cubeRootOfCube << endl;
+
+		// x^0.5 has infinite derivatives at zero of alternating signs.
+		const HReal trueSquare[] = { ZERO, ZERO, ONE, ZERO, ZERO };
+		const HReal trueSquareRoot[] = { ZERO, INFINITY, -INFINITY, INFINITY, -INFINITY };
+
+		bool bFailed = false;
+		for (int i = 0; i < depth; ++i)
+		{
+			bFailed = bFailed || square.getCoefficient(i) != trueSquare[i]
+				|| squareRoot.getCoefficient(i) != trueSquareRoot[i];
+		}
+
+		// The terms of x^(1/3) past t^3 depend on terms of x^3 past the depth.
+		for (int i = 0; i < 3; ++i)
+		{
+			bFailed = bFailed || cubeRootOfCube.getCoefficient(i) != (i == 1 ? ONE : ZERO);
+		}
+
+		if (bFailed)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[AutoDiff][TC" << inOutTestCount
+				<< "][Error] " << __LINE__ << ": "
+				<< "x^2 = " << square << ", x^0.5 = " << squareRoot
+				<< ", (x^3)^(1/3) = " << cubeRootOfCube << endl << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	{
+		cout << endl << "[AutoDiff][TC" << ++inOutTestCount
+			<< "] Powers of dual numbers at zero" << endl;
+
+		const auto sqrtAtZero = pow(Dual::variable(ZERO), 0.5);
+		const auto squareAtZero = pow(Dual::variable(ZERO), 2);
+		const auto identityAtZero = pow(HyperDual::variable(ZERO), 1);
+		const auto cubeAtZero = pow(HyperDual::variable(ZERO), 3);
+
+		cout << "[AutoDiff][TC" << inOutTestCount << "] sqrt(0) = " << sqrtAtZero.value
+			<< ", x^1 = (" << identityAtZero.value << ", " << identityAtZero.getDerivative()
+			<< ", " << identityAtZero.getSecondOrderDerivative() << ")" << endl;
+
+		// x^0.5 has an infinite slope at zero, but its value is zero, and integer powers are exact.
+		const bool bFailed = sqrtAtZero.value != ZERO || !(sqrtAtZero.derivative > ZERO)
+			|| squareAtZero.value != ZERO || squareAtZero.derivative != ZERO
+			|| identityAtZero.value != ZERO || identityAtZero.getDerivative() != ONE
+			|| identityAtZero.getSecondOrderDerivative() != ZERO
+			|| cubeAtZero.value != ZERO || cubeAtZero.getDerivative() != ZERO
+			|| cubeAtZero.getSecondOrderDerivative() != ZERO;
+
+		if (bFailed)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[AutoDiff][TC" << inOutTestCount
+				<< "][Error] " << __LINE__ << ": "
+				<< "pow of a dual number at zero is wrong, sqrt(0) = " << sqrtAtZero.value
+				<< ", x^1 = (" << identityAtZero.value << ", " << identityAtZero.getDerivative()
+				<< ", " << identityAtZero.getSecondOrderDerivative() << ")" << endl << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	return errorCount;
+}
+#endif // DO_TEST
+
+} // autodiff
+} // hmath
@@ -0,0 +1,361 @@
+#pragma once
+
+#include "hmathconfig.h"
+#include "hmathconstants.h"
+#include "hmathinlinebuffer.h"
+#include "hmathtypes.h"
+
+#include <cmath>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace hmath
+{
+namespace autodiff
+{
+	// Dual number, value + derivative * e where e^2 = 0.
+	// Evaluating a generic function on Dual::variable(x) gives f(x) and f'(x) at once.
+	struct Dual final
+	{
+		HReal value;
+		HReal derivative;
+
+		constexpr Dual()
+			: value(ZERO), derivative(ZERO)
+		{
+		}
+
+		constexpr Dual(HReal inValue, HReal inDerivative = ZERO)
+			: value(inValue), derivative(inDerivative)
+		{
+		}
+
+		static constexpr Dual variable(HReal x) { return Dual(x, ONE); }
+
+		// Applies a function g of which value and derivative at value are given.
+		constexpr Dual chain(HReal g, HReal dg) const { return Dual(g, dg * derivative); }
+
+		friend constexpr Dual operator- (const Dual& x) { return Dual(-x.value, -x.derivative); }
+
+		friend constexpr Dual operator+ (const Dual& lhs, const Dual& rhs)
+		{
+			return Dual(lhs.value + rhs.value, lhs.derivative + rhs.derivative);
+		}
+
+		friend constexpr Dual operator- (const Dual& lhs, const Dual& rhs)
+		{
+			return Dual(lhs.value - rhs.value, lhs.derivative - rhs.derivative);
+		}
+
+		friend constexpr Dual operator* (const Dual& lhs, const Dual& rhs)
+		{
+			return Dual(lhs.value * rhs.value, lhs.derivative * rhs.value + lhs.value * rhs.derivative);
+		}
+
+		friend constexpr Dual operator/ (const Dual& lhs, const Dual& rhs)
+		{
+			const HReal inverse = ONE / rhs.value;
+			const HReal value = lhs.value * inverse;
+
+			return Dual(value, (lhs.derivative - value * rhs.derivative) * inverse);
+		}
+
+		friend Dual exp(const Dual& x)
+		{
+			const HReal y = std::exp(x.value);
+			return x.chain(y, y);
+		}
+
+		friend Dual log(const Dual& x) { return x.chain(std::log(x.value), ONE / x.value); }
+
+		friend Dual sqrt(const Dual& x)
+		{
+			const HReal y = std::sqrt(x.value);
+			return x.chain(y, HALF / y);
+		}
+
+		friend Dual sin(const Dual& x) { return x.chain(std::sin(x.value), std::cos(x.value)); }
+		friend Dual cos(const Dual& x) { return x.chain(std::cos(x.value), -std::sin(x.value)); }
+
+		friend Dual tan(const Dual& x)
+		{
+			const HReal y = std::tan(x.value);
+			return x.chain(y, ONE + y * y);
+		}
+
+		// The derivative is taken from the value, except at zero, where e x^(e - 1) is evaluated directly,
+		// and a zero coefficient makes an exact zero rather than 0 * inf.
+		friend Dual pow(const Dual& x, HReal exponent)
+		{
+			const HReal y = std::pow(x.value, exponent);
+
+			if (x.value != ZERO)
+				return x.chain(y, exponent * y / x.value);
+
+			const HReal dy = exponent == ZERO ? ZERO : exponent * std::pow(x.value, exponent - ONE);
+			return x.chain(y, dy);
+		}
+	};
+
+	// Hyper-dual number, value + d1 e1 + d2 e2 + d12 e1 e2 where e1^2 = e2^2 = 0.
+	// Evaluating a generic function on HyperDual::variable(x) gives f(x), f'(x) and f''(x) at once,
+	// without the cancellation of nested finite differences.
+	struct HyperDual final
+	{
+		HReal value;
+		HReal d1;
+		HReal d2;
+		HReal d12;
+
+		constexpr HyperDual()
+			: value(ZERO), d1(ZERO), d2(ZERO), d12(ZERO)
+		{
+		}
+
+		constexpr HyperDual(HReal inValue, HReal inD1 = ZERO, HReal inD2 = ZERO, HReal inD12 = ZERO)
+			: value(inValue), d1(inD1), d2(inD2), d12(inD12)
+		{
+		}
+
+		static constexpr HyperDual variable(HReal x) { return HyperDual(x, ONE, ONE, ZERO); }
+
+		constexpr HReal getDerivative() const { return d1; }
+		constexpr HReal getSecondOrderDerivative() const { return d12; }
+
+		// Applies a function g of which value, first and second derivatives at value are given.
+		constexpr HyperDual chain(HReal g, HReal dg, HReal ddg) const
+		{
+			return HyperDual(g, dg * d1, dg * d2, dg * d12 + ddg * d1 * d2);
+		}
+
+		friend constexpr HyperDual operator- (const HyperDual& x)
+		{
+			return HyperDual(-x.value, -x.d1, -x.d2, -x.d12);
+		}
+
+		friend constexpr HyperDual operator+ (const HyperDual& lhs, const HyperDual& rhs)
+		{
+			return HyperDual(lhs.value + rhs.value, lhs.d1 + rhs.d1, lhs.d2 + rhs.d2, lhs.d12 + rhs.d12);
+		}
+
+		friend constexpr HyperDual operator- (const HyperDual& lhs, const HyperDual& rhs)
+		{
+			return HyperDual(lhs.value - rhs.value, lhs.d1 - rhs.d1, lhs.d2 - rhs.d2, lhs.d12 - rhs.d12);
+		}
+
+		friend constexpr HyperDual operator* (const HyperDual& lhs, const HyperDual& rhs)
+		{
+			return HyperDual(lhs.value * rhs.value,
+				lhs.d1 * rhs.value + lhs.value * rhs.d1,
+				lhs.d2 * rhs.value + lhs.value * rhs.d2,
+				lhs.d12 * rhs.value + lhs.d1 * rhs.d2 + lhs.d2 * rhs.d1 + lhs.value * rhs.d12);
+		}
+
+		friend constexpr HyperDual operator/ (const HyperDual& lhs, const HyperDual& rhs)
+		{
+			const HReal inverse = ONE / rhs.value;
+			return lhs * rhs.chain(inverse, -inverse * inverse, TWO * inverse * inverse * inverse);
+		}
+
+		friend HyperDual exp(const HyperDual& x)
+		{
+			const HReal y = std::exp(x.value);
+			return x.chain(y, y, y);
+		}
+
+		friend HyperDual log(const HyperDual& x)
+		{
+			const HReal inverse = ONE / x.value;
+			return x.chain(std::log(x.value), inverse, -inverse * inverse);
+		}
+
+		friend HyperDual sqrt(const HyperDual& x)
+		{
+			const HReal y = std::sqrt(x.value);
+			return x.chain(y, HALF / y, -HALF * HALF / (y * x.value));
+		}
+
+		friend HyperDual sin(const HyperDual& x)
+		{
+			const HReal s = std::sin(x.value);
+			return x.chain(s, std::cos(x.value), -s);
+		}
+
+		friend HyperDual cos(const HyperDual& x)
+		{
+			const HReal c = std::cos(x.value);
+			return x.chain(c, -std::sin(x.value), -c);
+		}
+
+		friend HyperDual tan(const HyperDual& x)
+		{
+			const HReal y = std::tan(x.value);
+			const HReal dy = ONE + y * y;
+			return x.chain(y, dy, TWO * y * dy);
+		}
+
+		friend HyperDual pow(const HyperDual& x, HReal exponent)
+		{
+			const HReal y = std::pow(x.value, exponent);
+			const HReal ddyCoeff = exponent * (exponent - ONE);
+
+			if (x.value != ZERO)
+				return x.chain(y, exponent * y / x.value, ddyCoeff * y / (x.value * x.value));
+
+			const HReal dy = exponent == ZERO ? ZERO : exponent * std::pow(x.value, exponent - ONE);
+			const HReal ddy = ddyCoeff == ZERO ? ZERO : ddyCoeff * std::pow(x.value, exponent - TWO);
+			return x.chain(y, dy, ddy);
+		}
+	};
+
+	// Exact derivatives by forward-mode automatic differentiation.
+	// They take generic callables, e.g. [](auto x) { return sin(x) * x; }, evaluated once on a dual number.
+	template <typename TFunc>
+	concept DualDifferentiable = std::is_invocable_r_v<Dual, TFunc, Dual>;
+
+	template <typename TFunc>
+	concept HyperDualDifferentiable = std::is_invocable_r_v<HyperDual, TFunc, HyperDual>;
+
+	template <DualDifferentiable TFunc>
+	HReal derivative(const TFunc& func, HReal x)
+	{
+		return Dual(func(Dual::variable(x))).derivative;
+	}
+
+	template <HyperDualDifferentiable TFunc>
+	HReal secondOrderDerivative(const TFunc& func, HReal x)
+	{
+		return HyperDual(func(HyperDual::variable(x))).getSecondOrderDerivative();
+	}
+
+	template <DualDifferentiable TFunc>
+	TFunc1 getDerivative(const TFunc& func)
+	{
+		return [func](HReal x) -> HReal
+		{
+			return derivative(func, x);
+		};
+	}
+
+	template <HyperDualDifferentiable TFunc>
+	TFunc1 getSecondOrderDerivative(const TFunc& func)
+	{
+		return [func](HReal x) -> HReal
+		{
+			return secondOrderDerivative(func, x);
+		};
+	}
+
+	// Newton-Raphson method taking f and f' from a single evaluation on a dual number.
+	// The conditions are the ones of analysis::newtonRaphsonMethod.
+	template <DualDifferentiable TFunc>
+	std::optional<HRoot> newtonRaphsonMethod(int& outIterationCount,
+		const TFunc& differentiableFunc, HReal start,
+		int maxCount = 30, HReal epsilon = SMALL_NUMBER)
+	{
+		outIterationCount = 0;
+
+		auto x = start;
+		Dual y = differentiableFunc(Dual::variable(x));
+		auto error = std::abs(y.value);
+		if (error < epsilon)
+			return HRoot{ x, error };
+
+		while (outIterationCount < maxCount)
+		{
+			++outIterationCount;
+
+			if (std::abs(y.derivative) < DIV_EPSILON)
+				return std::optional<HRoot>();
+
+			x = x - (y.value / y.derivative);
+			y = differentiableFunc(Dual::variable(x));
+
+			error = std::abs(y.value);
+			if (error < epsilon)
+				return HRoot{ x, error };
+		}
+
+		return std::optional<HRoot>();
+	}
+
+	// Truncated Taylor series for forward-mode automatic differentiation.
+	// coefficients[k] holds f^(k)(a) / k! at the expansion point a, up to depth coefficients.
+	// Evaluating a generic function on TaylorNumber::variable(a, depth) gives its Taylor expansion at a,
+	// with every derivative exact up to rounding, from a single evaluation.
+	class TaylorNumber final
+	{
+		using TCoefficients = InlineBuffer<HReal, 8>;
+
+	private:
+		TCoefficients coefficients;
+
+	public:
+		TaylorNumber() = default;
+		TaylorNumber(HReal constant, int depth);
+		~TaylorNumber() = default;
+
+		static TaylorNumber variable(HReal point, int depth);
+
+		TaylorNumber operator- () const;
+		TaylorNumber operator+ (const TaylorNumber& rhs) const;
+		TaylorNumber operator- (const TaylorNumber& rhs) const;
+		TaylorNumber operator* (const TaylorNumber& rhs) const;
+		TaylorNumber operator/ (const TaylorNumber& rhs) const;
+
+		TaylorNumber operator+ (HReal rhs) const;
+		TaylorNumber operator- (HReal rhs) const;
+		TaylorNumber operator* (HReal rhs) const;
+		TaylorNumber operator/ (HReal rhs) const;
+
+		friend TaylorNumber operator+ (HReal lhs, const TaylorNumber& rhs);
+		friend TaylorNumber operator- (HReal lhs, const TaylorNumber& rhs);
+		friend TaylorNumber operator* (HReal lhs, const TaylorNumber& rhs);
+		friend TaylorNumber operator/ (HReal lhs, const TaylorNumber& rhs);
+
+		friend std::ostream& operator<< (std::ostream& stream, const TaylorNumber& number);
+
+	public:
+		int getDepth() const;
+		HReal getValue() const;
+
+		// k-th Taylor coefficient, f^(k)(a) / k!
+		HReal getCoefficient(int index) const;
+
+		// k-th derivative, f^(k)(a)
+		HReal getDerivative(int order) const;
+
+		std::span<const HReal> getCoefficients() const;
+
+		friend TaylorNumber exp(const TaylorNumber& x);
+		friend TaylorNumber log(const TaylorNumber& x);
+		friend TaylorNumber sqrt(const TaylorNumber& x);
+		friend TaylorNumber sin(const TaylorNumber& x);
+		friend TaylorNumber cos(const TaylorNumber& x);
+		friend TaylorNumber tan(const TaylorNumber& x);
+		friend TaylorNumber pow(const TaylorNumber& x, HReal exponent);
+		friend TaylorNumber pow(const TaylorNumber& x, int exponent);
+
+	private:
+		static void sinCos(const TaylorNumber& x, TaylorNumber& outSin, TaylorNumber& outCos);
+	};
+
+	// Tag opting into an expansion by TaylorNumber, e.g. Polynomial(autodiff::TAYLOR_SERIES, func, point, depth),
+	// so that overloads taking other callables never evaluate them on TaylorNumber.
+	struct TaylorSeriesTag final
+	{
+	};
+
+	static constexpr TaylorSeriesTag TAYLOR_SERIES{};
+
+#if DO_TEST
+	int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
+#endif // DO_TEST
+
+} // autodiff
+} // hmath
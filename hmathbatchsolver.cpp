@@ -0,0 +1,145 @@
+#include "hmathbatchsolver.h"
+
+#include "hmathanalysis.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+
+namespace hmath
+{
+namespace batch
+{
+
+#if DO_TEST
+int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
+{
+	using namespace std;
+	using Clock = std::chrono::steady_clock;
+
+	int errorCount = 0;
+
+	// a_i x^3 + b_i = 0, parameters in structure-of-arrays
+	constexpr size_t count = 100000;
+
+	std::vector<HReal> as(count);
+	std::vector<HReal> bs(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		as[i] = 1 + (i % 97) * 0.02;
+		bs[i] = -5 + (i % 101) * 0.1;
+	}
+
+	auto func = [&as, &bs](size_t i, HReal x) -> HReal
+	{
+		return as[i] * x * x * x + bs[i];
+	};
+
+	auto derivativeFunc = [&as](size_t i, HReal x) -> HReal
+	{
+		return 3 * as[i] * x * x;
+	};
+
+	std::vector<std::optional<HRoot>> roots(count);
+	std::vector<int> iterationCounts(count);
+
+	// Compares every lane with the scalar solver.
+	auto check = [&](const char* name, double batchTime, auto&& scalarSolve)
+	{
+		size_t numMismatches = 0;
+		size_t numRoots = 0;
+
+		const auto startTime = Clock::now();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			int scalarCount = 0;
+			const TFunc1 scalarFunc = [&func, i](HReal x) { return func(i, x); };
+			const auto scalarRoot = scalarSolve(scalarCount, scalarFunc, i);
+
+			numRoots += roots[i] ? 1 : 0;
+
+			const bool bSameOutcome = scalarRoot.has_value() == roots[i].has_value()
+				&& scalarCount == iterationCounts[i]
+				&& (!scalarRoot || scalarRoot->value == roots[i]->value);
+
+			numMismatches += bSameOutcome ? 0 : 1;
+		}
+
+		const std::chrono::duration<double, std::milli> scalarTime = Clock::now() - startTime;
+
+		cout << "[Batch][TC" << inOutTestCount << "] " << name << ": " << numRoots << " roots of "
+			<< count << " equations, batch " << batchTime << " ms, scalar " << scalarTime.count()
+			<< " ms, mismatches = " << numMismatches << endl;
+
+		if (numMismatches > 0)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[Batch][TC" << inOutTestCount << "][Error] " << __LINE__ << ": " << name
+				<< " has " << numMismatches << " lanes different from the scalar solver." << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	};
+
+	{
+		cout << endl << "[Batch][TC" << ++inOutTestCount << "] Batched bisection method" << endl;
+
+		const std::vector<HReal> starts(count, -10);
+		const std::vector<HReal> ends(count, 10);
+
+		const auto startTime = Clock::now();
+		bisectionMethod(roots, iterationCounts, func, starts, ends);
+		const std::chrono::duration<double, std::milli> batchTime = Clock::now() - startTime;
+
+		check("Bisection", batchTime.count(), [](int& outCount, const TFunc1& scalarFunc, size_t)
+			{
+				return analysis::bisectionMethod(outCount, scalarFunc, -10, 10);
+			});
+	}
+
+	{
+		cout << endl << "[Batch][TC" << ++inOutTestCount << "] Batched Newton-Raphson method" << endl;
+
+		const std::vector<HReal> starts(count, -10);
+
+		const auto startTime = Clock::now();
+		newtonRaphsonMethod(roots, iterationCounts, func, derivativeFunc, starts);
+		const std::chrono::duration<double, std::milli> batchTime = Clock::now() - startTime;
+
+		check("Newton-Raphson", batchTime.count(), [&derivativeFunc](int& outCount, const TFunc1& scalarFunc, size_t i)
+			{
+				const TFunc1 scalarDerivative = [&derivativeFunc, i](HReal x) { return derivativeFunc(i, x); };
+				return analysis::newtonRaphsonMethod(outCount, scalarFunc, scalarDerivative, -10);
+			});
+	}
+
+	{
+		cout << endl << "[Batch][TC" << ++inOutTestCount << "] Batched secant method" << endl;
+
+		const std::vector<HReal> starts(count, -10);
+		const std::vector<HReal> starts2(count, -10 + EPSILON);
+
+		const auto startTime = Clock::now();
+		secantMethod(roots, iterationCounts, func, starts, starts2);
+		const std::chrono::duration<double, std::milli> batchTime = Clock::now() - startTime;
+
+		check("Secant", batchTime.count(), [](int& outCount, const TFunc1& scalarFunc, size_t)
+			{
+				return analysis::secantMethod(outCount, scalarFunc, -10, -10 + EPSILON);
+			});
+	}
+
+	return errorCount;
+}
+#endif // DO_TEST
+
+} // batch
+} // hmath
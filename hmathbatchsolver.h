@@ -0,0 +1,347 @@
+#pragma once
+
+#include "hmathconfig.h"
+#include "hmathconstants.h"
+#include "hmathtypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace hmath
+{
+
+// Root finders solving many independent equations of the same formula at once.
+// The function is a lane-wise callable f(lane, x), which reads the parameters of the lane
+// from structure-of-arrays blocks it captures, e.g. [&](size_t i, HReal x) { return a[i] * x + b[i]; }.
+// Every iteration advances a block of LANE_WIDTH lanes together with branch-free updates,
+// so that the loops vectorize once f is inlined. Converged lanes are masked off,
+// and blocks of which every lane has converged are skipped.
+// Each lane follows the same steps and reports the same outcome as the scalar solver in analysis.
+namespace batch
+{
+	static constexpr size_t LANE_WIDTH = 8;
+
+	// conditions
+	// The given function should be continous on range [starts[i], ends[i]] for each lane i.
+	// The sign of f(i, starts[i]) and f(i, ends[i]) should be different.
+	template <typename TFunc>
+	void bisectionMethod(std::span<std::optional<HRoot>> outRoots, std::span<int> outIterationCounts,
+		const TFunc& continuousFunc, std::span<const HReal> starts, std::span<const HReal> ends,
+		int maxCount = 30, HReal epsilon = SMALL_NUMBER)
+	{
+		const size_t count = std::min({ outRoots.size(), outIterationCounts.size(), starts.size(), ends.size() });
+
+		std::vector<HReal> lows(starts.begin(), starts.begin() + count);
+		std::vector<HReal> highs(ends.begin(), ends.begin() + count);
+		std::vector<uint8_t> lowNegatives(count);
+		std::vector<uint8_t> actives(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			outRoots[i].reset();
+			outIterationCounts[i] = 0;
+
+			const HReal sy = continuousFunc(i, lows[i]);
+			const HReal ey = continuousFunc(i, highs[i]);
+
+			if (std::abs(sy) < epsilon)
+			{
+				outRoots[i].emplace(lows[i], std::abs(sy));
+				continue;
+			}
+
+			if (std::abs(ey) < epsilon)
+			{
+				outRoots[i].emplace(highs[i], std::abs(ey));
+				continue;
+			}
+
+			lowNegatives[i] = std::signbit(sy);
+			actives[i] = std::signbit(sy) != std::signbit(ey);
+		}
+
+		bool bAnyActive = true;
+
+		for (int iteration = 0; iteration < maxCount && bAnyActive; ++iteration)
+		{
+			bAnyActive = false;
+
+			for (size_t block = 0; block < count; block += LANE_WIDTH)
+			{
+				const size_t width = std::min(LANE_WIDTH, count - block);
+
+				uint8_t bBlockActive = 0;
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					const size_t i = block + lane;
+					const HReal deltaRange = highs[i] - lows[i];
+
+					actives[i] &= static_cast<uint8_t>(!std::signbit(deltaRange) && std::abs(deltaRange) > epsilon);
+					bBlockActive |= actives[i];
+				}
+
+				if (bBlockActive == 0)
+					continue;
+
+				bAnyActive = true;
+
+				HReal xs[LANE_WIDTH];
+				HReal ys[LANE_WIDTH];
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					const size_t i = block + lane;
+					xs[lane] = lows[i] + (highs[i] - lows[i]) * HALF;
+				}
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					ys[lane] = continuousFunc(block + lane, xs[lane]);
+				}
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					const size_t i = block + lane;
+					if (actives[i] == 0)
+						continue;
+
+					++outIterationCounts[i];
+
+					const HReal error = std::abs(ys[lane]);
+					if (error < epsilon)
+					{
+						outRoots[i].emplace(xs[lane], error);
+						actives[i] = 0;
+						continue;
+					}
+
+					const bool bMoveHigh = static_cast<bool>(lowNegatives[i]) != std::signbit(ys[lane]);
+					highs[i] = bMoveHigh ? xs[lane] : highs[i];
+					lows[i] = bMoveHigh ? lows[i] : xs[lane];
+				}
+			}
+		}
+	}
+
+	// conditions
+	// The given function should be differentiable for every point.
+	// derivativeFunc(i, starts[i]) should not be zero.
+	template <typename TFunc, typename TDerivativeFunc>
+	void newtonRaphsonMethod(std::span<std::optional<HRoot>> outRoots, std::span<int> outIterationCounts,
+		const TFunc& func, const TDerivativeFunc& derivativeFunc, std::span<const HReal> starts,
+		int maxCount = 30, HReal epsilon = SMALL_NUMBER)
+	{
+		const size_t count = std::min({ outRoots.size(), outIterationCounts.size(), starts.size() });
+
+		std::vector<HReal> xs(starts.begin(), starts.begin() + count);
+		std::vector<HReal> ys(count);
+		std::vector<uint8_t> actives(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			outRoots[i].reset();
+			outIterationCounts[i] = 0;
+
+			ys[i] = func(i, xs[i]);
+
+			const HReal error = std::abs(ys[i]);
+			if (error < epsilon)
+			{
+				outRoots[i].emplace(xs[i], error);
+				continue;
+			}
+
+			actives[i] = 1;
+		}
+
+		bool bAnyActive = true;
+
+		for (int iteration = 0; iteration < maxCount && bAnyActive; ++iteration)
+		{
+			bAnyActive = false;
+
+			for (size_t block = 0; block < count; block += LANE_WIDTH)
+			{
+				const size_t width = std::min(LANE_WIDTH, count - block);
+
+				uint8_t bBlockActive = 0;
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					bBlockActive |= actives[block + lane];
+				}
+
+				if (bBlockActive == 0)
+					continue;
+
+				bAnyActive = true;
+
+				HReal dys[LANE_WIDTH];
+				HReal newXs[LANE_WIDTH];
+				HReal newYs[LANE_WIDTH];
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					dys[lane] = derivativeFunc(block + lane, xs[block + lane]);
+				}
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					const size_t i = block + lane;
+					newXs[lane] = xs[i] - (ys[i] / dys[lane]);
+				}
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					newYs[lane] = func(block + lane, newXs[lane]);
+				}
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					const size_t i = block + lane;
+					if (actives[i] == 0)
+						continue;
+
+					++outIterationCounts[i];
+
+					if (std::abs(dys[lane]) < DIV_EPSILON)
+					{
+						actives[i] = 0;
+						continue;
+					}
+
+					xs[i] = newXs[lane];
+					ys[i] = newYs[lane];
+
+					const HReal error = std::abs(ys[i]);
+					if (error < epsilon)
+					{
+						outRoots[i].emplace(xs[i], error);
+						actives[i] = 0;
+					}
+				}
+			}
+		}
+	}
+
+	// conditions
+	// The given function should be differentiable for every point.
+	// y`(starts[i]) should not be zero.
+	template <typename TFunc>
+	void secantMethod(std::span<std::optional<HRoot>> outRoots, std::span<int> outIterationCounts,
+		const TFunc& func, std::span<const HReal> starts, std::span<const HReal> starts2,
+		int maxCount = 30, HReal epsilon = SMALL_NUMBER)
+	{
+		const size_t count = std::min({ outRoots.size(), outIterationCounts.size(), starts.size(), starts2.size() });
+
+		std::vector<HReal> x1s(starts.begin(), starts.begin() + count);
+		std::vector<HReal> x2s(starts2.begin(), starts2.begin() + count);
+		std::vector<HReal> y1s(count);
+		std::vector<HReal> y2s(count);
+		std::vector<uint8_t> actives(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			outRoots[i].reset();
+			outIterationCounts[i] = 0;
+
+			y1s[i] = func(i, x1s[i]);
+			y2s[i] = func(i, x2s[i]);
+
+			if (std::abs(y1s[i]) < epsilon)
+			{
+				outRoots[i].emplace(x1s[i], std::abs(y1s[i]));
+				continue;
+			}
+
+			if (std::abs(y2s[i]) < epsilon)
+			{
+				outRoots[i].emplace(x2s[i], std::abs(y2s[i]));
+				continue;
+			}
+
+			actives[i] = 1;
+		}
+
+		bool bAnyActive = true;
+
+		for (int iteration = 0; iteration < maxCount && bAnyActive; ++iteration)
+		{
+			bAnyActive = false;
+
+			for (size_t block = 0; block < count; block += LANE_WIDTH)
+			{
+				const size_t width = std::min(LANE_WIDTH, count - block);
+
+				uint8_t bBlockActive = 0;
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					bBlockActive |= actives[block + lane];
+				}
+
+				if (bBlockActive == 0)
+					continue;
+
+				bAnyActive = true;
+
+				HReal dxs[LANE_WIDTH];
+				HReal dys[LANE_WIDTH];
+				HReal newXs[LANE_WIDTH];
+				HReal newYs[LANE_WIDTH];
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					const size_t i = block + lane;
+
+					dxs[lane] = x2s[i] - x1s[i];
+					dys[lane] = (y2s[i] - y1s[i]) / dxs[lane];
+					newXs[lane] = x2s[i] - (y2s[i] / dys[lane]);
+				}
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					newYs[lane] = func(block + lane, newXs[lane]);
+				}
+
+				for (size_t lane = 0; lane < width; ++lane)
+				{
+					const size_t i = block + lane;
+					if (actives[i] == 0)
+						continue;
+
+					++outIterationCounts[i];
+
+					if (std::abs(dxs[lane]) < DIV_EPSILON || std::abs(dys[lane]) < DIV_EPSILON)
+					{
+						actives[i] = 0;
+						continue;
+					}
+
+					x1s[i] = x2s[i];
+					y1s[i] = y2s[i];
+					x2s[i] = newXs[lane];
+					y2s[i] = newYs[lane];
+
+					const HReal error = std::abs(y2s[i]);
+					if (error < epsilon)
+					{
+						outRoots[i].emplace(x2s[i], error);
+						actives[i] = 0;
+					}
+				}
+			}
+		}
+	}
+
+#if DO_TEST
+	int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
+#endif // DO_TEST
+
+} // batch
+
+} // hmath
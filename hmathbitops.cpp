@@ -1,7 +1,10 @@
 #include "hmathbitops.h"
 
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 
@@ -174,6 +177,43 @@ bool isNegative(long double value)
 	return (bitValues & mask) != 0;
 }
 
+namespace
+{
+	// Maps the sign-magnitude bits of a float to a two's complement integer of the same order.
+	template <typename IntType, typename FloatType>
+	IntType toOrderedBits(FloatType value)
+	{
+		static_assert(sizeof(FloatType) == sizeof(IntType));
+
+		const IntType bits = std::bit_cast<IntType>(value);
+		return bits < 0 ? std::numeric_limits<IntType>::min() - bits : bits;
+	}
+
+	template <typename IntType, typename FloatType>
+	uint64_t getOrderedDistance(FloatType lhs, FloatType rhs)
+	{
+		if (std::isnan(lhs) || std::isnan(rhs))
+			return UINT64_MAX;
+
+		const int64_t lhsBits = toOrderedBits<IntType>(lhs);
+		const int64_t rhsBits = toOrderedBits<IntType>(rhs);
+
+		return lhsBits > rhsBits
+			? static_cast<uint64_t>(lhsBits) - static_cast<uint64_t>(rhsBits)
+			: static_cast<uint64_t>(rhsBits) - static_cast<uint64_t>(lhsBits);
+	}
+} // anonymous
+
+uint64_t getUlpDistance(float lhs, float rhs)
+{
+	return getOrderedDistance<int32_t>(lhs, rhs);
+}
+
+uint64_t getUlpDistance(double lhs, double rhs)
+{
+	return getOrderedDistance<int64_t>(lhs, rhs);
+}
+
 #if DO_TEST
 int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 {
@@ -441,6 +481,35 @@ int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 			}
 		}
 	}
+
+	{
+		cout << "[bitops][TC" << ++inOutTestCount << "] ULP distance" << endl;
+
+		const double denormal = std::numeric_limits<double>::denorm_min();
+		const float nextFloat = std::nextafter(std::nextafter(std::nextafter(1.0f, 2.0f), 2.0f), 2.0f);
+
+		const bool bPassed = getUlpDistance(1.0, std::nextafter(1.0, 2.0)) == 1
+			&& getUlpDistance(-0.0, 0.0) == 0
+			&& getUlpDistance(-denormal, denormal) == 2
+			&& getUlpDistance(nextFloat, 1.0f) == 3
+			&& getUlpDistance(-1.0, 1.0) == 2 * getUlpDistance(0.0, 1.0)
+			&& getUlpDistance(std::nan(""), 1.0) == UINT64_MAX;
+
+		if (!bPassed)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[bitops][TC" << inOutTestCount << "][Error] wrong ULP distance, 1 to next = "
+				<< getUlpDistance(1.0, std::nextafter(1.0, 2.0)) << ", -denormal to denormal = "
+				<< getUlpDistance(-denormal, denormal) << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
 	
 	return errorCount;
 }
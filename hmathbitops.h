@@ -60,6 +60,11 @@ bool isNegative(float value);
 bool isNegative(double value);
 bool isNegative(long double value);
 
+// Number of representable values from lhs to rhs, 0 if they are equal including -0 and +0.
+// UINT64_MAX if either is NaN.
+uint64_t getUlpDistance(float lhs, float rhs);
+uint64_t getUlpDistance(double lhs, double rhs);
+
 #if DO_TEST
 int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
 #endif // DO_TEST
@@ -0,0 +1,842 @@
+#include "hmathbytecode.h"
+
+#include "hmathconstants.h"
+#include "hmathinlinebuffer.h"
+#include "hmathutil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+
+namespace hmath
+{
+namespace bytecode
+{
+
+namespace
+{
+	int getNumOperands(OpCode op)
+	{
+		if (isBinary(op))
+			return 2;
+
+		if (isUnary(op) || op == OpCode::Call)
+			return 1;
+
+		return 0;
+	}
+
+	// Marks the nodes output depends on, walking backward since operands precede their nodes.
+	std::vector<uint8_t> findReachables(const std::vector<Node>& nodes, TNodeId output)
+	{
+		std::vector<uint8_t> reachables(output + 1);
+		reachables[output] = 1;
+
+		for (TNodeId id = output + 1; id-- > 0;)
+		{
+			if (reachables[id] == 0)
+				continue;
+
+			const Node& node = nodes[id];
+			for (int i = 0; i < getNumOperands(node.op); ++i)
+			{
+				reachables[node.operands[i]] = 1;
+			}
+		}
+
+		return reachables;
+	}
+
+	HReal applyUnary(OpCode op, HReal x)
+	{
+		switch (op)
+		{
+		case OpCode::Negate: return -x;
+		case OpCode::Abs: return std::abs(x);
+		case OpCode::Sqrt: return std::sqrt(x);
+		case OpCode::Exp: return std::exp(x);
+		case OpCode::Log: return std::log(x);
+		case OpCode::Sin: return std::sin(x);
+		case OpCode::Cos: return std::cos(x);
+		case OpCode::Tan: return std::tan(x);
+		default: return x;
+		}
+	}
+
+	HReal applyBinary(OpCode op, HReal lhs, HReal rhs)
+	{
+		switch (op)
+		{
+		case OpCode::Add: return lhs + rhs;
+		case OpCode::Subtract: return lhs - rhs;
+		case OpCode::Multiply: return lhs * rhs;
+		case OpCode::Divide: return lhs / rhs;
+		default: return lhs;
+		}
+	}
+
+	template <typename TOperation>
+	void applyUnary(HReal* target, const HReal* operand, size_t width, TOperation operation)
+	{
+		for (size_t i = 0; i < width; ++i)
+		{
+			target[i] = operation(operand[i]);
+		}
+	}
+
+	template <typename TOperation>
+	void applyBinary(HReal* target, const HReal* lhs, const HReal* rhs, size_t width, TOperation operation)
+	{
+		for (size_t i = 0; i < width; ++i)
+		{
+			target[i] = operation(lhs[i], rhs[i]);
+		}
+	}
+} // anonymous
+
+bool isUnary(OpCode op)
+{
+	return op >= OpCode::Negate && op <= OpCode::Tan;
+}
+
+bool isBinary(OpCode op)
+{
+	return op >= OpCode::Add && op <= OpCode::Divide;
+}
+
+TNodeId ExpressionGraph::input()
+{
+	return push(OpCode::Input, INVALID_NODE, INVALID_NODE, ZERO, 0);
+}
+
+TNodeId ExpressionGraph::constant(HReal value)
+{
+	return push(OpCode::Constant, INVALID_NODE, INVALID_NODE, value, 0);
+}
+
+TFunctionId ExpressionGraph::addFunction(TFunc1 func)
+{
+	functions.push_back(std::move(func));
+	return static_cast<TFunctionId>(functions.size() - 1);
+}
+
+TNodeId ExpressionGraph::call(TFunctionId function, TNodeId operand)
+{
+	if (function >= functions.size() || !functions[function])
+	{
+		using namespace std;
+		cerr << "[hmath][bytecode][Error] " << __func__ << ": invalid function " << function << endl;
+
+		return INVALID_NODE;
+	}
+
+	if (!isValid(operand))
+	{
+		using namespace std;
+		cerr << "[hmath][bytecode][Error] " << __func__ << ": invalid operand " << operand << endl;
+
+		return INVALID_NODE;
+	}
+
+	return push(OpCode::Call, operand, INVALID_NODE, ZERO, function);
+}
+
+TNodeId ExpressionGraph::call(TFunc1 func, TNodeId operand)
+{
+	if (!func)
+	{
+		using namespace std;
+		cerr << "[hmath][bytecode][Error] " << __func__ << ": func is null." << endl;
+
+		return INVALID_NODE;
+	}
+
+	return call(addFunction(std::move(func)), operand);
+}
+
+TNodeId ExpressionGraph::unary(OpCode op, TNodeId operand)
+{
+	if (!isUnary(op) || !isValid(operand))
+	{
+		using namespace std;
+		cerr << "[hmath][bytecode][Error] " << __func__ << ": invalid operation "
+			<< static_cast<int>(op) << " on " << operand << endl;
+
+		return INVALID_NODE;
+	}
+
+	return push(op, operand, INVALID_NODE, ZERO, 0);
+}
+
+TNodeId ExpressionGraph::binary(OpCode op, TNodeId lhs, TNodeId rhs)
+{
+	if (!isBinary(op) || !isValid(lhs) || !isValid(rhs))
+	{
+		using namespace std;
+		cerr << "[hmath][bytecode][Error] " << __func__ << ": invalid operation "
+			<< static_cast<int>(op) << " on " << lhs << ", " << rhs << endl;
+
+		return INVALID_NODE;
+	}
+
+	return push(op, lhs, rhs, ZERO, 0);
+}
+
+size_t ExpressionGraph::getNumNodes() const
+{
+	return nodes.size();
+}
+
+const Node& ExpressionGraph::getNode(TNodeId id) const
+{
+	return nodes[id];
+}
+
+HReal ExpressionGraph::evaluate(TNodeId output, HReal x) const
+{
+	if (!isValid(output))
+	{
+		using namespace std;
+		cerr << "[hmath][bytecode][Error] " << __func__ << ": invalid output " << output << endl;
+
+		return ZERO;
+	}
+
+	std::vector<HReal> values(output + 1);
+
+	for (TNodeId id = 0; id <= output; ++id)
+	{
+		const Node& node = nodes[id];
+
+		switch (node.op)
+		{
+		case OpCode::Input:
+			values[id] = x;
+			break;
+
+		case OpCode::Constant:
+			values[id] = node.value;
+			break;
+
+		case OpCode::Call:
+			values[id] = functions[node.function](values[node.operands[0]]);
+			break;
+
+		default:
+			values[id] = isBinary(node.op)
+				? applyBinary(node.op, values[node.operands[0]], values[node.operands[1]])
+				: applyUnary(node.op, values[node.operands[0]]);
+			break;
+		}
+	}
+
+	return values[output];
+}
+
+OptimizationReport ExpressionGraph::optimize(TNodeId& inOutOutput)
+{
+	OptimizationReport report;
+	report.numNodesBefore = nodes.size();
+	report.numNodesAfter = nodes.size();
+
+	if (!isValid(inOutOutput))
+	{
+		using namespace std;
+		cerr << "[hmath][bytecode][Error] " << __func__ << ": invalid output " << inOutOutput << endl;
+
+		return report;
+	}
+
+	std::vector<uint8_t> reachables = findReachables(nodes, inOutOutput);
+
+	// Nodes are keyed by operation, operands, the bits of the constant and the function.
+	using TKey = std::tuple<OpCode, TNodeId, TNodeId, uint64_t, TFunctionId>;
+
+	std::vector<Node> newNodes;
+	std::map<TKey, TNodeId> uniqueNodes;
+	std::vector<TNodeId> newIds(inOutOutput + 1, INVALID_NODE);
+
+	auto emit = [&newNodes, &uniqueNodes, &report](Node node) -> TNodeId
+	{
+		if (node.op == OpCode::Add || node.op == OpCode::Multiply)
+		{
+			std::sort(node.operands, node.operands + 2);
+		}
+
+		uint64_t valueBits = 0;
+		std::memcpy(&valueBits, &node.value, sizeof(node.value));
+
+		const TKey key(node.op, node.operands[0], node.operands[1], valueBits, node.function);
+
+		auto found = uniqueNodes.find(key);
+		if (found != uniqueNodes.end())
+		{
+			++report.numDeduplicated;
+			return found->second;
+		}
+
+		const auto id = static_cast<TNodeId>(newNodes.size());
+		newNodes.push_back(node);
+		uniqueNodes.emplace(key, id);
+
+		return id;
+	};
+
+	auto makeConstant = [](HReal value) -> Node
+	{
+		return Node{ OpCode::Constant, { INVALID_NODE, INVALID_NODE }, value, 0 };
+	};
+
+	auto isConstant = [&newNodes](TNodeId id, HReal value) -> bool
+	{
+		return newNodes[id].op == OpCode::Constant && newNodes[id].value == value;
+	};
+
+	for (TNodeId id = 0; id <= inOutOutput; ++id)
+	{
+		if (reachables[id] == 0)
+			continue;
+
+		Node node = nodes[id];
+		for (int i = 0; i < getNumOperands(node.op); ++i)
+		{
+			node.operands[i] = newIds[node.operands[i]];
+		}
+
+		const TNodeId lhs = node.operands[0];
+		const TNodeId rhs = node.operands[1];
+
+		if (isUnary(node.op))
+		{
+			if (newNodes[lhs].op == OpCode::Constant)
+			{
+				++report.numFolded;
+				newIds[id] = emit(makeConstant(applyUnary(node.op, newNodes[lhs].value)));
+				continue;
+			}
+
+			if (node.op == OpCode::Negate && newNodes[lhs].op == OpCode::Negate)
+			{
+				++report.numSimplified;
+				newIds[id] = newNodes[lhs].operands[0];
+				continue;
+			}
+		}
+		else if (isBinary(node.op))
+		{
+			if (newNodes[lhs].op == OpCode::Constant && newNodes[rhs].op == OpCode::Constant)
+			{
+				++report.numFolded;
+				newIds[id] = emit(makeConstant(applyBinary(node.op, newNodes[lhs].value, newNodes[rhs].value)));
+				continue;
+			}
+
+			const bool bRightIdentity = (node.op == OpCode::Add && isConstant(rhs, ZERO))
+				|| (node.op == OpCode::Subtract && isConstant(rhs, ZERO))
+				|| (node.op == OpCode::Multiply && isConstant(rhs, ONE))
+				|| (node.op == OpCode::Divide && isConstant(rhs, ONE));
+
+			const bool bLeftIdentity = (node.op == OpCode::Add && isConstant(lhs, ZERO))
+				|| (node.op == OpCode::Multiply && isConstant(lhs, ONE));
+
+			if (bRightIdentity || bLeftIdentity)
+			{
+				++report.numSimplified;
+				newIds[id] = bRightIdentity ? lhs : rhs;
+				continue;
+			}
+
+			if (node.op == OpCode::Subtract && isConstant(lhs, ZERO))
+			{
+				++report.numSimplified;
+				newIds[id] = emit(Node{ OpCode::Negate, { rhs, INVALID_NODE }, ZERO, 0 });
+				continue;
+			}
+		}
+
+		newIds[id] = emit(node);
+	}
+
+	// Operands replaced by folding or simplification are left unused, so they are swept out.
+	const TNodeId newOutput = newIds[inOutOutput];
+
+	reachables = findReachables(newNodes, newOutput);
+
+	nodes.clear();
+	newIds.assign(newOutput + 1, INVALID_NODE);
+
+	for (TNodeId id = 0; id <= newOutput; ++id)
+	{
+		if (reachables[id] == 0)
+			continue;
+
+		Node node = newNodes[id];
+		for (int i = 0; i < getNumOperands(node.op); ++i)
+		{
+			node.operands[i] = newIds[node.operands[i]];
+		}
+
+		newIds[id] = static_cast<TNodeId>(nodes.size());
+		nodes.push_back(node);
+	}
+
+	inOutOutput = newIds[newOutput];
+
+	report.numNodesAfter = nodes.size();
+
+	return report;
+}
+
+std::optional<Program> ExpressionGraph::compile(TNodeId output) const
+{
+	if (!isValid(output))
+	{
+		using namespace std;
+		cerr << "[hmath][bytecode][Error] " << __func__ << ": invalid output " << output << endl;
+
+		return std::nullopt;
+	}
+
+	// Only the nodes the output depends on are compiled.
+	// The last use of a node tells when its register can be reused.
+	std::vector<uint8_t> reachables(output + 1);
+	std::vector<TNodeId> lastUses(output + 1, 0);
+
+	reachables[output] = 1;
+	lastUses[output] = INVALID_NODE;
+
+	for (TNodeId id = output + 1; id-- > 0;)
+	{
+		if (reachables[id] == 0)
+			continue;
+
+		const Node& node = nodes[id];
+		for (int i = 0; i < getNumOperands(node.op); ++i)
+		{
+			const TNodeId operand = node.operands[i];
+			reachables[operand] = 1;
+			lastUses[operand] = std::max(lastUses[operand], id);
+		}
+	}
+
+	Program program;
+	program.instructions.clear();
+	program.functions = functions;
+	program.numRegisters = 0;
+
+	std::vector<uint32_t> registers(output + 1);
+	std::vector<uint32_t> freeRegisters;
+
+	for (TNodeId id = 0; id <= output; ++id)
+	{
+		if (reachables[id] == 0)
+			continue;
+
+		const Node& node = nodes[id];
+		const int numOperands = getNumOperands(node.op);
+
+		Instruction instruction = { node.op, 0, { 0, 0 } };
+
+		for (int i = 0; i < numOperands; ++i)
+		{
+			instruction.operands[i] = registers[node.operands[i]];
+		}
+
+		if (node.op == OpCode::Constant)
+		{
+			instruction.operands[0] = static_cast<uint32_t>(program.constants.size());
+			program.constants.push_back(node.value);
+		}
+		else if (node.op == OpCode::Call)
+		{
+			instruction.operands[1] = node.function;
+		}
+
+		// The operands are read before the target is written in every lane,
+		// so the target may take over a register released here.
+		for (int i = 0; i < numOperands; ++i)
+		{
+			const TNodeId operand = node.operands[i];
+			const bool bDuplicated = i > 0 && operand == node.operands[0];
+
+			if (lastUses[operand] == id && !bDuplicated)
+			{
+				freeRegisters.push_back(registers[operand]);
+			}
+		}
+
+		if (freeRegisters.empty())
+		{
+			instruction.target = program.numRegisters++;
+		}
+		else
+		{
+			instruction.target = freeRegisters.back();
+			freeRegisters.pop_back();
+		}
+
+		registers[id] = instruction.target;
+		program.instructions.push_back(instruction);
+	}
+
+	program.outputRegister = registers[output];
+
+	return program;
+}
+
+bool ExpressionGraph::isValid(TNodeId id) const
+{
+	return id < nodes.size();
+}
+
+TNodeId ExpressionGraph::push(OpCode op, TNodeId operand0, TNodeId operand1, HReal value, TFunctionId function)
+{
+	nodes.push_back(Node{ op, { operand0, operand1 }, value, function });
+	return static_cast<TNodeId>(nodes.size() - 1);
+}
+
+// A default Program is the identity, f(x) = x.
+Program::Program()
+	: instructions({ Instruction{ OpCode::Input, 0, { 0, 0 } } })
+	, numRegisters(1)
+	, outputRegister(0)
+{
+}
+
+HReal Program::evaluate(HReal x) const
+{
+	InlineBuffer<HReal, 16> registers;
+	registers.resize(numRegisters);
+
+	execute(&x, registers.data(), 1, 1);
+
+	return registers[outputRegister];
+}
+
+void Program::evaluate(std::span<const HReal> values, std::span<HReal> outResults) const
+{
+	const size_t count = std::min(values.size(), outResults.size());
+	if (count == 0)
+		return;
+
+	std::vector<HReal> registers(static_cast<size_t>(numRegisters) * BLOCK_SIZE);
+	const HReal* output = registers.data() + static_cast<size_t>(outputRegister) * BLOCK_SIZE;
+
+	for (size_t block = 0; block < count; block += BLOCK_SIZE)
+	{
+		const size_t width = std::min(BLOCK_SIZE, count - block);
+
+		execute(values.data() + block, registers.data(), BLOCK_SIZE, width);
+		std::copy(output, output + width, outResults.begin() + block);
+	}
+}
+
+TFunc1 Program::asFunction() const
+{
+	return [program = *this](HReal x) -> HReal
+	{
+		return program.evaluate(x);
+	};
+}
+
+size_t Program::getNumInstructions() const
+{
+	return instructions.size();
+}
+
+uint32_t Program::getNumRegisters() const
+{
+	return numRegisters;
+}
+
+void Program::execute(const HReal* values, HReal* registers, size_t stride, size_t width) const
+{
+	for (const auto& instruction : instructions)
+	{
+		HReal* target = registers + instruction.target * stride;
+		const HReal* lhs = registers + instruction.operands[0] * stride;
+
+		switch (instruction.op)
+		{
+		case OpCode::Input:
+			std::copy(values, values + width, target);
+			break;
+
+		case OpCode::Constant:
+			std::fill(target, target + width, constants[instruction.operands[0]]);
+			break;
+
+		case OpCode::Call:
+			applyUnary(target, lhs, width, functions[instruction.operands[1]]);
+			break;
+
+		case OpCode::Negate:
+			applyUnary(target, lhs, width, [](HReal x) { return -x; });
+			break;
+
+		case OpCode::Abs:
+			applyUnary(target, lhs, width, [](HReal x) { return std::abs(x); });
+			break;
+
+		case OpCode::Sqrt:
+			applyUnary(target, lhs, width, [](HReal x) { return std::sqrt(x); });
+			break;
+
+		case OpCode::Exp:
+			applyUnary(target, lhs, width, [](HReal x) { return std::exp(x); });
+			break;
+
+		case OpCode::Log:
+			applyUnary(target, lhs, width, [](HReal x) { return std::log(x); });
+			break;
+
+		case OpCode::Sin:
+			applyUnary(target, lhs, width, [](HReal x) { return std::sin(x); });
+			break;
+
+		case OpCode::Cos:
+			applyUnary(target, lhs, width, [](HReal x) { return std::cos(x); });
+			break;
+
+		case OpCode::Tan:
+			applyUnary(target, lhs, width, [](HReal x) { return std::tan(x); });
+			break;
+
+		case OpCode::Add:
+			applyBinary(target, lhs, registers + instruction.operands[1] * stride, width,
+				[](HReal a, HReal b) { return a + b; });
+			break;
+
+		case OpCode::Subtract:
+			applyBinary(target, lhs, registers + instruction.operands[1] * stride, width,
+				[](HReal a, HReal b) { return a - b; });
+			break;
+
+		case OpCode::Multiply:
+			applyBinary(target, lhs, registers + instruction.operands[1] * stride, width,
+				[](HReal a, HReal b) { return a * b; });
+			break;
+
+		case OpCode::Divide:
+			applyBinary(target, lhs, registers + instruction.operands[1] * stride, width,
+				[](HReal a, HReal b) { return a / b; });
+			break;
+		}
+	}
+}
+
+#if DO_TEST
+int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
+{
+	using namespace std;
+	using namespace util;
+	using Clock = std::chrono::steady_clock;
+
+	int errorCount = 0;
+
+	auto report = [&](int line, const string& text)
+	{
+		++errorCount;
+
+		ostringstream msg;
+		msg << "[Bytecode][TC" << inOutTestCount << "][Error] " << line << ": " << text << endl;
+
+		const auto errorMsg = msg.view();
+		cerr << errorMsg;
+
+		outErrorMessages.emplace_back(errorMsg);
+	};
+
+	const TFunc1 square = [](HReal x) { return x * x; };
+
+	// f(x) = sin(x) * x + 3 / (x + 2) - square(cos(x) - 1)
+	ExpressionGraph graph;
+	const TNodeId x = graph.input();
+	const TNodeId left = graph.multiply(graph.unary(OpCode::Sin, x), x);
+	const TNodeId middle = graph.divide(graph.constant(3), graph.add(x, graph.constant(2)));
+	const TNodeId right = graph.call(square, graph.subtract(graph.unary(OpCode::Cos, x), graph.constant(1)));
+	const TNodeId output = graph.subtract(graph.add(left, middle), right);
+
+	// The same function built by nesting TFunc1 with the util operators
+	const TFunc1 sinTimesX = [](HReal value) { return std::sin(value) * value; };
+	const TFunc1 fraction = [](HReal value) { return 3 / (value + 2); };
+	const TFunc1 cosMinusOne = [](HReal value) { return std::cos(value) - 1; };
+	const TFunc1 trueFunc = sinTimesX + fraction - composite(cosMinusOne, square);
+
+	{
+		cout << endl << "[Bytecode][TC" << ++inOutTestCount << "] Compile an expression graph" << endl;
+
+		const auto program = graph.compile(output);
+		if (!program)
+		{
+			report(__LINE__, "failed to compile.");
+		}
+		else
+		{
+			HReal error = ZERO;
+			for (HReal value = -1; value < 1; value += 0.001)
+			{
+				const HReal y = trueFunc(value);
+				error = std::max(error, std::abs(graph.evaluate(output, value) - y));
+				error = std::max(error, std::abs(program->evaluate(value) - y));
+			}
+
+			cout << "[Bytecode][TC" << inOutTestCount << "] nodes = " << graph.getNumNodes()
+				<< ", instructions = " << program->getNumInstructions()
+				<< ", registers = " << program->getNumRegisters() << ", error = " << error << endl;
+
+			if (error > EPSILON)
+			{
+				report(__LINE__, "compiled program differs with error = " + to_string(error));
+			}
+
+			if (program->getNumRegisters() >= program->getNumInstructions())
+			{
+				report(__LINE__, "registers are not reused, registers = " + to_string(program->getNumRegisters()));
+			}
+		}
+
+		if (graph.add(x, INVALID_NODE) != INVALID_NODE || graph.compile(INVALID_NODE))
+		{
+			report(__LINE__, "an invalid operand SHOULD be rejected.");
+		}
+
+		if (Program().evaluate(0.5) != 0.5)
+		{
+			report(__LINE__, "a default program SHOULD be the identity.");
+		}
+	}
+
+	{
+		cout << endl << "[Bytecode][TC" << ++inOutTestCount << "] Batched evaluation" << endl;
+
+		const auto program = graph.compile(output);
+
+		constexpr size_t count = 100000;
+
+		vector<HReal> values(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = -ONE + static_cast<HReal>(i) * (TWO / count);
+		}
+
+		vector<HReal> results(count);
+		vector<HReal> trueResults(count);
+
+		auto startTime = Clock::now();
+		for (size_t i = 0; i < count; ++i)
+		{
+			trueResults[i] = trueFunc(values[i]);
+		}
+		const std::chrono::duration<double, std::milli> functionTime = Clock::now() - startTime;
+
+		startTime = Clock::now();
+		program->evaluate(values, results);
+		const std::chrono::duration<double, std::milli> programTime = Clock::now() - startTime;
+
+		HReal error = ZERO;
+		for (size_t i = 0; i < count; ++i)
+		{
+			error = std::max(error, std::abs(results[i] - trueResults[i]));
+		}
+
+		cout << "[Bytecode][TC" << inOutTestCount << "] " << count << " inputs, nested TFunc1 "
+			<< functionTime.count() << " ms, bytecode " << programTime.count()
+			<< " ms, error = " << error << endl;
+
+		if (error > EPSILON)
+		{
+			report(__LINE__, "batched evaluation differs with error = " + to_string(error));
+		}
+	}
+
+	{
+		cout << endl << "[Bytecode][TC" << ++inOutTestCount << "] Optimize an expression graph" << endl;
+
+		int numCalls = 0;
+
+		ExpressionGraph optimizedGraph;
+		const TFunctionId f = optimizedGraph.addFunction([&numCalls](HReal value)
+			{
+				++numCalls;
+				return value * value;
+			});
+
+		// f(x) + f(x) * 3 + (x * 1 + 0) * (2 + 3) - (0 - -(-x))
+		const TNodeId in = optimizedGraph.input();
+		const TNodeId sum = optimizedGraph.add(optimizedGraph.call(f, in),
+			optimizedGraph.multiply(optimizedGraph.call(f, in), optimizedGraph.constant(3)));
+		const TNodeId identity = optimizedGraph.add(optimizedGraph.multiply(in, optimizedGraph.constant(1)),
+			optimizedGraph.constant(0));
+		const TNodeId folded = optimizedGraph.add(optimizedGraph.constant(2), optimizedGraph.constant(3));
+		const TNodeId negated = optimizedGraph.subtract(optimizedGraph.constant(0),
+			optimizedGraph.negate(optimizedGraph.negate(in)));
+
+		TNodeId result = optimizedGraph.subtract(
+			optimizedGraph.add(sum, optimizedGraph.multiply(identity, folded)), negated);
+
+		auto expected = [](HReal value) { return 4 * value * value + 5 * value + value; };
+
+		const auto optimization = optimizedGraph.optimize(result);
+		const auto program = optimizedGraph.compile(result);
+
+		HReal error = ZERO;
+		numCalls = 0;
+
+		for (HReal value = -1; value < 1; value += 0.01)
+		{
+			error = std::max(error, std::abs(program->evaluate(value) - expected(value)));
+		}
+
+		cout << "[Bytecode][TC" << inOutTestCount << "] nodes " << optimization.numNodesBefore
+			<< " -> " << optimization.numNodesAfter << ", eliminated = " << optimization.getNumEliminated()
+			<< ", folded = " << optimization.numFolded << ", simplified = " << optimization.numSimplified
+			<< ", deduplicated = " << optimization.numDeduplicated << ", calls = " << numCalls
+			<< ", error = " << error << endl;
+
+		if (error > EPSILON)
+		{
+			report(__LINE__, "optimized program differs with error = " + to_string(error));
+		}
+
+		if (numCalls != 200 || optimization.numDeduplicated == 0 || optimization.numFolded == 0 || optimization.numSimplified == 0)
+		{
+			report(__LINE__, "common subexpressions, constants or identities are not optimized.");
+		}
+	}
+
+	{
+		cout << endl << "[Bytecode][TC" << ++inOutTestCount << "] Optimize the compiled graph" << endl;
+
+		ExpressionGraph optimizedGraph = graph;
+		TNodeId result = output;
+
+		const auto optimization = optimizedGraph.optimize(result);
+
+		HReal error = ZERO;
+		for (HReal value = -1; value < 1; value += 0.01)
+		{
+			error = std::max(error, std::abs(optimizedGraph.evaluate(result, value) - graph.evaluate(output, value)));
+		}
+
+		cout << "[Bytecode][TC" << inOutTestCount << "] nodes " << optimization.numNodesBefore
+			<< " -> " << optimization.numNodesAfter << ", error = " << error << endl;
+
+		if (error > 0)
+		{
+			report(__LINE__, "optimization changed the result with error = " + to_string(error));
+		}
+	}
+
+	return errorCount;
+}
+#endif // DO_TEST
+
+} // bytecode
+} // hmath
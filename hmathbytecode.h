@@ -0,0 +1,165 @@
+#pragma once
+
+#include "hmathconfig.h"
+#include "hmathtypes.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace hmath
+{
+
+// Functions assembled at runtime, e.g. from a configuration, of which shape isn't known at compile time.
+// An ExpressionGraph is built node by node, and compiled into a flat register Program.
+// The Program is run by a small interpreter, which executes every instruction over a block of inputs,
+// so that the dispatch is amortized and each instruction is a tight loop the compiler vectorizes.
+namespace bytecode
+{
+	using TNodeId = uint32_t;
+	using TFunctionId = uint32_t;
+
+	static constexpr TNodeId INVALID_NODE = UINT32_MAX;
+
+	enum class OpCode : uint8_t
+	{
+		Input,
+		Constant,
+		Call,
+		Negate,
+		Abs,
+		Sqrt,
+		Exp,
+		Log,
+		Sin,
+		Cos,
+		Tan,
+		Add,
+		Subtract,
+		Multiply,
+		Divide
+	};
+
+	bool isUnary(OpCode op);
+	bool isBinary(OpCode op);
+
+	struct Node final
+	{
+		OpCode op;
+		TNodeId operands[2];
+		HReal value;
+		TFunctionId function;
+	};
+
+	class Program;
+
+	struct OptimizationReport final
+	{
+		size_t numNodesBefore = 0;
+		size_t numNodesAfter = 0;
+		size_t numFolded = 0;
+		size_t numSimplified = 0;
+		size_t numDeduplicated = 0;
+
+		size_t getNumEliminated() const { return numNodesBefore - numNodesAfter; }
+	};
+
+	// Directed acyclic graph of operations on a single input x.
+	// Operands of a node are always created before the node, so the order of nodes is topological.
+	class ExpressionGraph final
+	{
+	private:
+		std::vector<Node> nodes;
+		std::vector<TFunc1> functions;
+
+	public:
+		ExpressionGraph() = default;
+		~ExpressionGraph() = default;
+
+		TNodeId input();
+		TNodeId constant(HReal value);
+
+		// Registers an opaque function, which can be called by multiple nodes.
+		TFunctionId addFunction(TFunc1 func);
+		TNodeId call(TFunctionId function, TNodeId operand);
+		TNodeId call(TFunc1 func, TNodeId operand);
+
+		TNodeId unary(OpCode op, TNodeId operand);
+		TNodeId binary(OpCode op, TNodeId lhs, TNodeId rhs);
+
+		TNodeId negate(TNodeId operand) { return unary(OpCode::Negate, operand); }
+		TNodeId add(TNodeId lhs, TNodeId rhs) { return binary(OpCode::Add, lhs, rhs); }
+		TNodeId subtract(TNodeId lhs, TNodeId rhs) { return binary(OpCode::Subtract, lhs, rhs); }
+		TNodeId multiply(TNodeId lhs, TNodeId rhs) { return binary(OpCode::Multiply, lhs, rhs); }
+		TNodeId divide(TNodeId lhs, TNodeId rhs) { return binary(OpCode::Divide, lhs, rhs); }
+
+		size_t getNumNodes() const;
+		const Node& getNode(TNodeId id) const;
+
+		// Evaluates the graph node by node, as a reference for the compiled Program.
+		HReal evaluate(TNodeId output, HReal x) const;
+
+		// Rewrites the graph to the nodes output depends on, and updates output to its new id.
+		// Identical subexpressions are merged, constant subexpressions are folded,
+		// and identities such as x + 0, x * 1 and -(-x) are removed.
+		// Calls of the same function id on the same operand are merged, i.e. functions are assumed to be pure.
+		// Ids of other nodes are invalidated.
+		OptimizationReport optimize(TNodeId& inOutOutput);
+
+		std::optional<Program> compile(TNodeId output) const;
+
+	private:
+		bool isValid(TNodeId id) const;
+		TNodeId push(OpCode op, TNodeId operand0, TNodeId operand1, HReal value, TFunctionId function);
+	};
+
+	struct Instruction final
+	{
+		OpCode op;
+		uint32_t target;
+		uint32_t operands[2];
+	};
+
+	// Register bytecode compiled from an ExpressionGraph.
+	// Registers are reused once their values are no longer needed.
+	class Program final
+	{
+		friend class ExpressionGraph;
+
+	public:
+		static constexpr size_t BLOCK_SIZE = 64;
+
+	private:
+		std::vector<Instruction> instructions;
+		std::vector<HReal> constants;
+		std::vector<TFunc1> functions;
+		uint32_t numRegisters;
+		uint32_t outputRegister;
+
+	public:
+		Program();
+		~Program() = default;
+
+		HReal evaluate(HReal x) const;
+		void evaluate(std::span<const HReal> values, std::span<HReal> outResults) const;
+
+		TFunc1 asFunction() const;
+
+		size_t getNumInstructions() const;
+		uint32_t getNumRegisters() const;
+
+	private:
+		// Runs every instruction over width inputs. Register r of lane i is registers[r * stride + i].
+		void execute(const HReal* values, HReal* registers, size_t stride, size_t width) const;
+	};
+
+#if DO_TEST
+	int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
+#endif // DO_TEST
+
+} // bytecode
+
+} // hmath
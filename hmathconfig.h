@@ -2,4 +2,9 @@
 
 #define DO_TEST 1
 #define USE_HIGH_PRECISION 1
+// The AVX2 and AVX-512 paths are also compiled in only when the compiler targets them, see HMATH_SIMD_ISA of CMakeLists.txt.
+#define USE_SIMD 1
+
+// Number of coefficients a Polynomial keeps inline before spilling to the heap
+#define POLYNOMIAL_INLINE_CAPACITY 8
 
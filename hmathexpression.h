@@ -0,0 +1,188 @@
+#pragma once
+
+#include "hmathtypes.h"
+
+#include <algorithm>
+#include <concepts>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+
+namespace hmath
+{
+
+// Expression templates for the function algebra of util.
+// Operators on expressions build a statically typed tree, e.g. lift(f) + lift(g) * 2.0,
+// of which a call is inlined into a single function body without allocation or indirect calls.
+// An expression is erased to TFunc1 only when asFunction() is called explicitly.
+namespace util
+{
+	template <typename TDerived>
+	class Expression
+	{
+	public:
+		const TDerived& derived() const { return static_cast<const TDerived&>(*this); }
+
+		TFunc1 asFunction() const { return derived(); }
+
+		void evaluate(std::span<const HReal> values, std::span<HReal> outResults) const
+		{
+			const TDerived& expression = derived();
+			const size_t count = std::min(values.size(), outResults.size());
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				outResults[i] = expression(values[i]);
+			}
+		}
+	};
+
+	template <typename T>
+	concept ExpressionType = std::derived_from<std::remove_cvref_t<T>, Expression<std::remove_cvref_t<T>>>;
+
+	// f(x) = value
+	class Constant final : public Expression<Constant>
+	{
+	private:
+		HReal value;
+
+	public:
+		constexpr explicit Constant(HReal inValue) : value(inValue) {}
+
+		constexpr HReal operator() (HReal) const { return value; }
+	};
+
+	// f(x) = x
+	class Identity final : public Expression<Identity>
+	{
+	public:
+		constexpr HReal operator() (HReal x) const { return x; }
+	};
+
+	// Expression calling a callable HReal(HReal) stored by value.
+	template <typename TFunc>
+	class Lifted final : public Expression<Lifted<TFunc>>
+	{
+	private:
+		TFunc func;
+
+	public:
+		explicit Lifted(TFunc inFunc) : func(std::move(inFunc)) {}
+
+		HReal operator() (HReal x) const { return func(x); }
+	};
+
+	template <typename TOperand, typename TOperation>
+	class UnaryExpression final : public Expression<UnaryExpression<TOperand, TOperation>>
+	{
+	private:
+		TOperand operand;
+
+	public:
+		explicit UnaryExpression(const TOperand& inOperand) : operand(inOperand) {}
+
+		HReal operator() (HReal x) const { return TOperation::apply(operand(x)); }
+	};
+
+	template <typename TLeft, typename TRight, typename TOperation>
+	class BinaryExpression final : public Expression<BinaryExpression<TLeft, TRight, TOperation>>
+	{
+	private:
+		TLeft left;
+		TRight right;
+
+	public:
+		BinaryExpression(const TLeft& inLeft, const TRight& inRight) : left(inLeft), right(inRight) {}
+
+		HReal operator() (HReal x) const { return TOperation::apply(left(x), right(x)); }
+	};
+
+	// outer(inner(x))
+	template <typename TInner, typename TOuter>
+	class CompositeExpression final : public Expression<CompositeExpression<TInner, TOuter>>
+	{
+	private:
+		TInner inner;
+		TOuter outer;
+
+	public:
+		CompositeExpression(const TInner& inInner, const TOuter& inOuter) : inner(inInner), outer(inOuter) {}
+
+		HReal operator() (HReal x) const { return outer(inner(x)); }
+	};
+
+	struct NegateOperation final { static constexpr HReal apply(HReal x) { return -x; } };
+	struct AddOperation final { static constexpr HReal apply(HReal lhs, HReal rhs) { return lhs + rhs; } };
+	struct SubtractOperation final { static constexpr HReal apply(HReal lhs, HReal rhs) { return lhs - rhs; } };
+	struct MultiplyOperation final { static constexpr HReal apply(HReal lhs, HReal rhs) { return lhs * rhs; } };
+	struct DivideOperation final { static constexpr HReal apply(HReal lhs, HReal rhs) { return lhs / rhs; } };
+
+	template <typename TFunc>
+		requires (!ExpressionType<TFunc> && std::is_invocable_r_v<HReal, const std::decay_t<TFunc>&, HReal>)
+	Lifted<std::decay_t<TFunc>> lift(TFunc&& func)
+	{
+		return Lifted<std::decay_t<TFunc>>(std::forward<TFunc>(func));
+	}
+
+	constexpr Constant constant(HReal value) { return Constant(value); }
+	constexpr Identity identity() { return Identity(); }
+
+	template <ExpressionType TOperand>
+	UnaryExpression<TOperand, NegateOperation> operator- (const TOperand& operand)
+	{
+		return UnaryExpression<TOperand, NegateOperation>(operand);
+	}
+
+	template <typename TOperation, ExpressionType TLeft, ExpressionType TRight>
+	BinaryExpression<TLeft, TRight, TOperation> makeBinary(const TLeft& left, const TRight& right)
+	{
+		return BinaryExpression<TLeft, TRight, TOperation>(left, right);
+	}
+
+	template <ExpressionType TLeft, ExpressionType TRight>
+	auto operator+ (const TLeft& left, const TRight& right) { return makeBinary<AddOperation>(left, right); }
+
+	template <ExpressionType TLeft>
+	auto operator+ (const TLeft& left, HReal right) { return makeBinary<AddOperation>(left, Constant(right)); }
+
+	template <ExpressionType TRight>
+	auto operator+ (HReal left, const TRight& right) { return makeBinary<AddOperation>(Constant(left), right); }
+
+	template <ExpressionType TLeft, ExpressionType TRight>
+	auto operator- (const TLeft& left, const TRight& right) { return makeBinary<SubtractOperation>(left, right); }
+
+	template <ExpressionType TLeft>
+	auto operator- (const TLeft& left, HReal right) { return makeBinary<SubtractOperation>(left, Constant(right)); }
+
+	template <ExpressionType TRight>
+	auto operator- (HReal left, const TRight& right) { return makeBinary<SubtractOperation>(Constant(left), right); }
+
+	template <ExpressionType TLeft, ExpressionType TRight>
+	auto operator* (const TLeft& left, const TRight& right) { return makeBinary<MultiplyOperation>(left, right); }
+
+	template <ExpressionType TLeft>
+	auto operator* (const TLeft& left, HReal right) { return makeBinary<MultiplyOperation>(left, Constant(right)); }
+
+	template <ExpressionType TRight>
+	auto operator* (HReal left, const TRight& right) { return makeBinary<MultiplyOperation>(Constant(left), right); }
+
+	template <ExpressionType TLeft, ExpressionType TRight>
+	auto operator/ (const TLeft& left, const TRight& right) { return makeBinary<DivideOperation>(left, right); }
+
+	template <ExpressionType TLeft>
+	auto operator/ (const TLeft& left, HReal right) { return makeBinary<DivideOperation>(left, Constant(right)); }
+
+	template <ExpressionType TRight>
+	auto operator/ (HReal left, const TRight& right) { return makeBinary<DivideOperation>(Constant(left), right); }
+
+	// func2(func1(x)), in the same order as composite of TFunc1.
+	template <ExpressionType TFunc1st, ExpressionType TFunc2nd>
+	CompositeExpression<TFunc1st, TFunc2nd> composite(const TFunc1st& func1, const TFunc2nd& func2)
+	{
+		return CompositeExpression<TFunc1st, TFunc2nd>(func1, func2);
+	}
+
+} // util
+
+} // hmath
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "hmathtypes.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+
+namespace hmath
+{
+	// Non-owning reference to a callable HReal(HReal).
+	// Unlike TFunc1, binding a lambda neither copies nor allocates, and a call is a single indirect call
+	// with no type-erased copy in between. It shouldn't outlive the callable it refers to,
+	// so it suits parameters of functions that only call it, while TFunc1 remains for stored functions.
+	// Plain functions are kept by their pointer, which can't be converted to a data pointer.
+	class FunctionRef final
+	{
+		using TFunction = HReal(*)(HReal);
+
+		union TCallable
+		{
+			const void* object;
+			TFunction function;
+		};
+
+		using TInvoker = HReal(*)(TCallable, HReal);
+
+	private:
+		TCallable callable;
+		TInvoker invoker;
+
+	public:
+		FunctionRef() noexcept
+			: callable{ nullptr }, invoker(nullptr)
+		{
+		}
+
+		FunctionRef(std::nullptr_t) noexcept
+			: FunctionRef()
+		{
+		}
+
+		// An empty TFunc1 makes a null reference.
+		FunctionRef(const TFunc1& func) noexcept
+			: callable{ func ? std::addressof(func) : nullptr }
+			, invoker(func ? &invoke<TFunc1> : nullptr)
+		{
+		}
+
+		// A null function pointer makes a null reference.
+		FunctionRef(TFunction func) noexcept
+			: invoker(func ? &invokeFunction : nullptr)
+		{
+			callable.function = func;
+		}
+
+		template <typename TFunc>
+			requires (!std::is_same_v<std::remove_cvref_t<TFunc>, FunctionRef>
+				&& !std::is_same_v<std::remove_cvref_t<TFunc>, TFunc1>
+				&& !std::is_function_v<TFunc>
+				&& std::is_invocable_r_v<HReal, const TFunc&, HReal>)
+		FunctionRef(const TFunc& func) noexcept
+			: callable{ std::addressof(func) }, invoker(&invoke<TFunc>)
+		{
+		}
+
+		FunctionRef(const FunctionRef&) noexcept = default;
+		~FunctionRef() = default;
+
+		FunctionRef& operator= (const FunctionRef&) noexcept = default;
+
+		HReal operator() (HReal value) const
+		{
+			return invoker(callable, value);
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return invoker != nullptr;
+		}
+
+	private:
+		template <typename TFunc>
+		static HReal invoke(TCallable inCallable, HReal value)
+		{
+			return (*static_cast<const TFunc*>(inCallable.object))(value);
+		}
+
+		static HReal invokeFunction(TCallable inCallable, HReal value)
+		{
+			return inCallable.function(value);
+		}
+	};
+} // hmath
@@ -1,15 +1,62 @@
 #include "hmathfunctionsequence.h"
 
+#include "hmath.h"
+
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <sstream>
 
 
 namespace hmath
 {
 
+namespace
+{
+	// Bit pattern of x, which tells -0 from +0 and matches NaN with itself, unlike ==.
+	uint64_t getBits(HReal x)
+	{
+		uint64_t bits = 0;
+		std::memcpy(&bits, &x, sizeof(x));
+
+		return bits;
+	}
+} // anonymous
+
+FrozenSequence::FrozenSequence()
+	: FrozenSequence(FunctionSequence())
+{
+}
+
+FrozenSequence::FrozenSequence(FunctionSequence inSequence)
+	: sequence(std::make_shared<const FunctionSequence>(std::move(inSequence)))
+{
+}
+
+void FrozenSequence::evaluate(std::span<const HReal> values, std::span<HReal> outResults) const
+{
+	if (sequence == nullptr)
+	{
+		FunctionSequence().get(values, outResults);
+		return;
+	}
+
+	sequence->get(values, outResults);
+}
+
+size_t FrozenSequence::getNumStages() const
+{
+	return sequence == nullptr ? 0 : sequence->functions.size();
+}
+
 FunctionSequence::FunctionSequence(std::initializer_list<TFunc1> list)
 {
 	functions.reserve(list.size());
+	affineMaps.reserve(list.size());
 
 	for (auto func : list)
 	{
@@ -21,6 +68,8 @@ FunctionSequence::FunctionSequence(std::initializer_list<TFunc1> list)
 		}
 
 		functions.push_back(func);
+		batchFunctions.emplace_back();
+		affineMaps.emplace_back();
 	}
 }
 
@@ -34,31 +83,70 @@ void FunctionSequence::add(TFunc1 func)
 	}
 
 	functions.push_back(func);
+	batchFunctions.emplace_back();
+	affineMaps.emplace_back();
+}
+
+void FunctionSequence::addAffine(HReal scale, HReal offset)
+{
+	const AffineMap map{ scale, offset };
+
+	functions.push_back(map);
+	batchFunctions.emplace_back();
+	affineMaps.push_back(map);
+}
+
+void FunctionSequence::addBatch(TBatchFunc1 func)
+{
+	if (!func)
+	{
+		using namespace std;
+		cerr << "[FunctionSequnece][Error] addBatch: Null function found!" << endl;
+		return;
+	}
+
+	// Single inputs go through the same function as a batch of one.
+	functions.push_back([func](HReal x) -> HReal
+	{
+		HReal result = x;
+		func(std::span<const HReal>(&x, 1), std::span<HReal>(&result, 1));
+
+		return result;
+	});
+
+	batchFunctions.push_back(std::move(func));
+	affineMaps.emplace_back();
 }
 
 void FunctionSequence::clear()
 {
 	functions.clear();
+	batchFunctions.clear();
+	affineMaps.clear();
 }
 
 void FunctionSequence::empty()
 {
 	std::vector<TFunc1>().swap(functions);
+	std::vector<TBatchFunc1>().swap(batchFunctions);
+	std::vector<std::optional<AffineMap>>().swap(affineMaps);
+}
+
+FrozenSequence FunctionSequence::freeze() const
+{
+	return FrozenSequence(*this);
 }
 
 TFunc1 FunctionSequence::asFunction() const
 {
-	return[*this](HReal value)->HReal
-	{
-		return get(value);
-	};
+	return freeze();
 }
 
 HReal FunctionSequence::get(HReal x) const
 {
 	HReal result = x;
 
-	for (auto func : functions)
+	for (const auto& func : functions)
 	{
 		result = func(result);
 	}
@@ -81,11 +169,182 @@ HReal FunctionSequence::getSub(HReal x, int start, int end) const
 	return result;
 }
 
+void FunctionSequence::get(std::span<const HReal> values, std::span<HReal> outResults) const
+{
+	getSub(values, outResults, 0, static_cast<int>(functions.size()));
+}
+
+void FunctionSequence::getSub(std::span<const HReal> values, std::span<HReal> outResults, int start, int end) const
+{
+	start = truncateIndex(start);
+	end = truncateIndex(end);
+
+	applyTiled(start, std::max(start, end), values, outResults);
+}
+
 int FunctionSequence::truncateIndex(int index) const
 {
 	return std::clamp(index, 0, static_cast<int>(functions.size()));
 }
 
+void FunctionSequence::applyTiled(size_t start, size_t end,
+	std::span<const HReal> values, std::span<HReal> outResults) const
+{
+	const size_t count = std::min(values.size(), outResults.size());
+
+	if (values.data() != outResults.data())
+	{
+		std::copy(values.begin(), values.begin() + count, outResults.begin());
+	}
+
+	// Output of batch stages, which don't evaluate in place
+	std::array<HReal, TILE_SIZE> scratch;
+
+	for (size_t tile = 0; tile < count; tile += TILE_SIZE)
+	{
+		HReal* results = outResults.data() + tile;
+		const size_t width = std::min(TILE_SIZE, count - tile);
+
+		for (size_t i = start; i < end; ++i)
+		{
+			if (batchFunctions[i])
+			{
+				batchFunctions[i](std::span<const HReal>(results, width), std::span<HReal>(scratch.data(), width));
+				std::copy(scratch.begin(), scratch.begin() + width, results);
+			}
+			else if (affineMaps[i])
+			{
+				const AffineMap map = *affineMaps[i];
+
+				for (size_t j = 0; j < width; ++j)
+				{
+					results[j] = map(results[j]);
+				}
+			}
+			else
+			{
+				const TFunc1& func = functions[i];
+
+				for (size_t j = 0; j < width; ++j)
+				{
+					results[j] = func(results[j]);
+				}
+			}
+		}
+	}
+}
+
+SequenceCache::SequenceCache(const FunctionSequence& sequence)
+	: functions(sequence.functions)
+	, numLeaves(1)
+	, recordedX(0)
+{
+	while (numLeaves < functions.size())
+	{
+		numLeaves *= 2;
+	}
+
+	// Node 1 is the root, and the children of node i are 2i and 2i + 1.
+	// Padding leaves are identities.
+	tree.resize(numLeaves * 2, AffineMap{ 1, 0 });
+
+	for (size_t i = 0; i < functions.size(); ++i)
+	{
+		tree[numLeaves + i] = sequence.affineMaps[i];
+	}
+
+	for (size_t node = numLeaves; node-- > 1;)
+	{
+		const auto& left = tree[node * 2];
+		const auto& right = tree[node * 2 + 1];
+
+		tree[node] = (left && right) ? std::optional<AffineMap>(left->then(*right)) : std::nullopt;
+	}
+}
+
+void SequenceCache::record(HReal x)
+{
+	recordedX = x;
+
+	rows.assign(functions.size() + 1, std::vector<HReal>());
+
+	auto& row = rows[0];
+	row.reserve(functions.size() + 1);
+	row.push_back(x);
+
+	for (const auto& func : functions)
+	{
+		row.push_back(func(row.back()));
+	}
+}
+
+HReal SequenceCache::getIntermediate(int index) const
+{
+	if (rows.empty())
+	{
+		using namespace std;
+		cerr << "[SequenceCache][Error] getIntermediate: Nothing recorded!" << endl;
+
+		return recordedX;
+	}
+
+	return rows[0][truncateIndex(index)];
+}
+
+HReal SequenceCache::getSub(HReal x, int start, int end)
+{
+	start = truncateIndex(start);
+	end = truncateIndex(end);
+
+	if (end <= start)
+		return x;
+
+	if (rows.empty() || getBits(x) != getBits(recordedX))
+		return apply(1, 0, numLeaves, start, end, x);
+
+	// Rows grow only as far as queried, so that rows of many start indices don't take O(n^2).
+	auto& row = rows[start];
+	if (row.empty())
+	{
+		row.reserve(end - start + 1);
+		row.push_back(x);
+	}
+
+	for (size_t i = start + row.size() - 1; i < static_cast<size_t>(end); ++i)
+	{
+		row.push_back(functions[i](row.back()));
+	}
+
+	return row[end - start];
+}
+
+size_t SequenceCache::getNumStages() const
+{
+	return functions.size();
+}
+
+int SequenceCache::truncateIndex(int index) const
+{
+	return std::clamp(index, 0, static_cast<int>(functions.size()));
+}
+
+HReal SequenceCache::apply(size_t node, size_t nodeBegin, size_t nodeEnd, size_t start, size_t end, HReal x) const
+{
+	if (end <= nodeBegin || nodeEnd <= start)
+		return x;
+
+	if (start <= nodeBegin && nodeEnd <= end && tree[node])
+		return (*tree[node])(x);
+
+	if (nodeEnd - nodeBegin == 1)
+		return functions[nodeBegin](x);
+
+	const size_t middle = nodeBegin + (nodeEnd - nodeBegin) / 2;
+
+	x = apply(node * 2, nodeBegin, middle, start, end, x);
+	return apply(node * 2 + 1, middle, nodeEnd, start, end, x);
+}
+
 #if DO_TEST
 int FunctionSequence::DoTest(int& inOutTestCount,
 	std::vector<std::string>& outErrorMessages)
@@ -104,6 +363,331 @@ int FunctionSequence::DoTest(int& inOutTestCount,
 			fSeqs.add(squareFunc);
 	}
 
+	{
+		cout << "[hmath][FunctionSequence][TC" << ++inOutTestCount << "] Batch evaluation" << endl;
+
+		using Clock = std::chrono::steady_clock;
+
+		FunctionSequence fSeqs;
+		for (int i = 0; i < 20; ++i)
+		{
+			fSeqs.add([i](HReal x) -> HReal { return std::sin(x) * 0.5 + i * 0.01; });
+			fSeqs.add([](HReal x) -> HReal { return x * x - 0.25; });
+		}
+
+		constexpr size_t count = 100000;
+
+		vector<HReal> values(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = -1 + static_cast<HReal>(i) * (2.0 / count);
+		}
+
+		vector<HReal> results(count);
+		vector<HReal> subResults(count);
+
+		auto startTime = Clock::now();
+		fSeqs.get(values, results);
+		const std::chrono::duration<double, std::milli> batchTime = Clock::now() - startTime;
+
+		fSeqs.getSub(values, subResults, 3, 17);
+
+		HReal error = 0;
+
+		startTime = Clock::now();
+		for (size_t i = 0; i < count; ++i)
+		{
+			error = std::max(error, std::abs(results[i] - fSeqs.get(values[i])));
+		}
+		const std::chrono::duration<double, std::milli> scalarTime = Clock::now() - startTime;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			error = std::max(error, std::abs(subResults[i] - fSeqs.getSub(values[i], 3, 17)));
+		}
+
+		// In place
+		fSeqs.get(values, values);
+		for (size_t i = 0; i < count; ++i)
+		{
+			error = std::max(error, std::abs(values[i] - results[i]));
+		}
+
+		cout << "[hmath][FunctionSequence][TC" << inOutTestCount << "] " << count << " inputs, batch "
+			<< batchTime.count() << " ms, scalar " << scalarTime.count() << " ms, error = " << error << endl;
+
+		if (error > 0)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[hmath][FunctionSequence][TC" << inOutTestCount
+				<< "][Error] batch evaluation differs with error = " << error << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	{
+		cout << "[hmath][FunctionSequence][TC" << ++inOutTestCount << "] Batch stages" << endl;
+
+		auto squareFunc = [](HReal x) -> HReal { return x * x - 0.25; };
+
+		int numBatchCalls = 0;
+		auto batchSquareFunc = [&numBatchCalls, squareFunc](std::span<const HReal> values, std::span<HReal> outResults)
+		{
+			++numBatchCalls;
+
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				outResults[i] = squareFunc(values[i]);
+			}
+		};
+
+		FunctionSequence fSeqs;
+		FunctionSequence scalarSeqs;
+		for (int i = 0; i < 10; ++i)
+		{
+			fSeqs.addBatch(batchSquareFunc);
+			fSeqs.addAffine(0.5, i * 0.01);
+
+			scalarSeqs.add(squareFunc);
+			scalarSeqs.add([i](HReal x) -> HReal { return 0.5 * x + i * 0.01; });
+		}
+
+		constexpr size_t count = 5000;
+		constexpr size_t numTiles = (count + FunctionSequence::TILE_SIZE - 1) / FunctionSequence::TILE_SIZE;
+
+		vector<HReal> values(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = -1 + static_cast<HReal>(i) * (2.0 / count);
+		}
+
+		vector<HReal> results(count);
+		fSeqs.get(values, results);
+
+		const int numTiledCalls = numBatchCalls;
+
+		vector<HReal> frozenResults(count);
+		fSeqs.freeze().evaluate(values, frozenResults);
+
+		HReal error = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const HReal trueY = scalarSeqs.get(values[i]);
+
+			error = std::max(error, std::abs(results[i] - trueY));
+			error = std::max(error, std::abs(frozenResults[i] - trueY));
+			error = std::max(error, std::abs(fSeqs.get(values[i]) - trueY));
+		}
+
+		cout << "[hmath][FunctionSequence][TC" << inOutTestCount << "] " << count << " inputs, batch calls = "
+			<< numTiledCalls << ", error = " << error << endl;
+
+		if (error > 0 || numTiledCalls != static_cast<int>(10 * numTiles))
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[hmath][FunctionSequence][TC" << inOutTestCount << "][Error] batch stages error = " << error
+				<< ", batch calls = " << numTiledCalls << ", expected " << 10 * numTiles << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	{
+		cout << "[hmath][FunctionSequence][TC" << ++inOutTestCount << "] Freeze" << endl;
+
+		using Clock = std::chrono::steady_clock;
+
+		auto sinFunc = [](HReal x) -> HReal { return std::sin(x) * 0.5 + 0.1; };
+		auto squareFunc = [](HReal x) -> HReal { return x * x - 0.25; };
+
+		FunctionSequence fSeqs;
+		for (int i = 0; i < 4; ++i)
+		{
+			fSeqs.add(sinFunc);
+			fSeqs.add(squareFunc);
+		}
+
+		const FrozenSequence frozen = fSeqs.freeze();
+		const TFunc1 func = fSeqs.asFunction();
+		const auto pipeline = makePipeline(sinFunc, squareFunc, sinFunc, squareFunc,
+			sinFunc, squareFunc, sinFunc, squareFunc);
+
+		constexpr auto constantPipeline = makePipeline([](HReal x) { return x * 2; }, [](HReal x) { return x + 1; });
+		static_assert(constantPipeline(3) == 7);
+
+		static_assert(sizeof(FrozenSequence) == sizeof(std::shared_ptr<const FunctionSequence>));
+
+		const auto allocationCount = GetAllocationCount();
+		const FrozenSequence copied = frozen;
+		const auto numAllocations = GetAllocationCount() - allocationCount;
+
+		// Copies of the function share the stages. The only allocation allowed is the storage of TFunc1 itself,
+		// where the standard library keeps only trivially copyable callables inline.
+		const auto funcAllocationCount = GetAllocationCount();
+		const TFunc1 copiedFunc = func;
+		const auto numFuncAllocations = GetAllocationCount() - funcAllocationCount;
+
+		// Clearing the sequence doesn't change what was frozen.
+		fSeqs.clear();
+
+		HReal error = 0;
+		for (HReal x = -1; x < 1; x += 0.01)
+		{
+			HReal trueY = x;
+			for (int i = 0; i < 4; ++i)
+			{
+				trueY = squareFunc(sinFunc(trueY));
+			}
+
+			error = std::max(error, std::abs(copied(x) - trueY));
+			error = std::max(error, std::abs(copiedFunc(x) - trueY));
+			error = std::max(error, std::abs(pipeline(x) - trueY));
+		}
+
+		constexpr int numIterations = 100000;
+
+		auto measure = [](const auto& f) -> double
+		{
+			HReal sum = 0;
+
+			const auto startTime = Clock::now();
+			for (int i = 0; i < numIterations; ++i)
+			{
+				sum += f(i * 1e-5);
+			}
+			const std::chrono::duration<double, std::nano> elapsed = Clock::now() - startTime;
+
+			volatile HReal sink = sum;
+			(void)sink;
+
+			return elapsed.count() / numIterations;
+		};
+
+		cout << "[hmath][FunctionSequence][TC" << inOutTestCount << "] stages = " << copied.getNumStages()
+			<< ", frozen " << measure(copied) << " ns, pipeline " << measure(pipeline)
+			<< " ns, copy allocations = " << numAllocations << ", function copy allocations = " << numFuncAllocations
+			<< ", error = " << error << endl;
+
+		// A moved-from sequence has no stages.
+		FrozenSequence moved = frozen;
+		const FrozenSequence movedTo = std::move(moved);
+		const bool bMovedFromValid = moved.getNumStages() == 0 && moved(0.5) == 0.5 && movedTo.getNumStages() == 8;
+
+		if (error > 0 || numAllocations != 0 || numFuncAllocations > 1 || copied.getNumStages() != 8 || !bMovedFromValid)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[hmath][FunctionSequence][TC" << inOutTestCount << "][Error] frozen sequence error = "
+				<< error << ", copy allocations = " << numAllocations
+				<< ", function copy allocations = " << numFuncAllocations << ", moved-from valid = " << bMovedFromValid << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	{
+		cout << "[hmath][FunctionSequence][TC" << ++inOutTestCount << "] Sequence cache" << endl;
+
+		using Clock = std::chrono::steady_clock;
+
+		constexpr int numStages = 4096;
+
+		FunctionSequence fSeqs;
+		for (int i = 0; i < numStages; ++i)
+		{
+			if (i % 1024 == 512)
+			{
+				fSeqs.add([](HReal x) -> HReal { return std::sin(x); });
+				continue;
+			}
+
+			fSeqs.addAffine(1 + ((i % 7) - 3) * 1e-4, ((i % 5) - 2) * 1e-3);
+		}
+
+		SequenceCache cache(fSeqs);
+		const HReal recordedX = 0.3;
+		cache.record(recordedX);
+
+		HReal recordedError = 0;
+		HReal affineError = 0;
+
+		for (int i = 0; i <= numStages; i += 256)
+		{
+			recordedError = std::max(recordedError, std::abs(cache.getIntermediate(i) - fSeqs.getSub(recordedX, 0, i)));
+		}
+
+		double sequenceTime = 0;
+		double cacheTime = 0;
+
+		for (int query = 0; query < 200; ++query)
+		{
+			// Overlapping ranges from a few start indices, to inspect intermediate stages
+			const int start = (query % 4) * 1000;
+			const int end = std::min(numStages, start + (query * 101) % numStages);
+			const HReal x = query % 2 == 0 ? recordedX : -0.2 + query * 1e-3;
+
+			auto startTime = Clock::now();
+			const HReal trueY = fSeqs.getSub(x, start, end);
+			sequenceTime += std::chrono::duration<double, std::micro>(Clock::now() - startTime).count();
+
+			startTime = Clock::now();
+			const HReal y = cache.getSub(x, start, end);
+			cacheTime += std::chrono::duration<double, std::micro>(Clock::now() - startTime).count();
+
+			auto& error = x == recordedX ? recordedError : affineError;
+			error = std::max(error, std::abs(y - trueY));
+		}
+
+		cout << "[hmath][FunctionSequence][TC" << inOutTestCount << "] 200 queries on " << numStages
+			<< " stages, getSub " << sequenceTime << " us, cache " << cacheTime
+			<< " us, recorded error = " << recordedError << ", affine error = " << affineError << endl;
+
+		// The recorded input is matched by bit pattern, so -0 misses the row of +0, and NaN hits its own row.
+		int numReciprocalCalls = 0;
+		FunctionSequence reciprocalSeqs;
+		reciprocalSeqs.add([&numReciprocalCalls](HReal x) -> HReal { ++numReciprocalCalls; return 1 / x; });
+
+		SequenceCache reciprocalCache(reciprocalSeqs);
+		reciprocalCache.record(0.0);
+		const bool bSignedZeroMissed = reciprocalCache.getSub(-0.0, 0, 1) < 0;
+
+		const HReal nan = std::numeric_limits<HReal>::quiet_NaN();
+		reciprocalCache.record(nan);
+		const int numCallsBeforeNaN = numReciprocalCalls;
+		reciprocalCache.getSub(nan, 0, 1);
+		const bool bNaNHit = numReciprocalCalls == numCallsBeforeNaN;
+
+		if (recordedError > 0 || affineError > 1e-12 || !bSignedZeroMissed || !bNaNHit)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[hmath][FunctionSequence][TC" << inOutTestCount << "][Error] sequence cache error, recorded = "
+				<< recordedError << ", affine = " << affineError << ", signed zero missed = " << bSignedZeroMissed
+				<< ", NaN hit = " << bNaNHit << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
 	return errorCount;
 }
 
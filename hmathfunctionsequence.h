@@ -3,15 +3,102 @@
 #include "hmathconfig.h"
 #include "hmathtypes.h"
 
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 
 namespace hmath
 {
+	// f(x) = scale * x + offset, of which compositions are affine maps again.
+	struct AffineMap final
+	{
+		HReal scale;
+		HReal offset;
+
+		constexpr HReal operator() (HReal x) const { return scale * x + offset; }
+
+		// next(this(x))
+		constexpr AffineMap then(const AffineMap& next) const
+		{
+			return AffineMap{ next.scale * scale, next.scale * offset + next.offset };
+		}
+	};
+
+	class FunctionSequence;
+
+	// Immutable sequence of runtime functions applied in order, made by FunctionSequence::freeze().
+	// Stages are shared between copies, so copying is O(1) and doesn't allocate,
+	// and a call runs over a fixed contiguous array of stages.
+	// Wrapped in a TFunc1, each copy still allocates once for the std::function itself,
+	// since the standard library keeps only trivially copyable callables inline.
+	// A moved-from sequence has no stages and returns x as it is.
+	class FrozenSequence final
+	{
+	private:
+		std::shared_ptr<const FunctionSequence> sequence;
+
+	public:
+		FrozenSequence();
+		explicit FrozenSequence(FunctionSequence inSequence);
+		~FrozenSequence() = default;
+
+		FrozenSequence(const FrozenSequence&) = default;
+		FrozenSequence(FrozenSequence&&) noexcept = default;
+		FrozenSequence& operator= (const FrozenSequence&) = default;
+		FrozenSequence& operator= (FrozenSequence&&) noexcept = default;
+
+		HReal operator() (HReal x) const;
+
+		void evaluate(std::span<const HReal> values, std::span<HReal> outResults) const;
+
+		size_t getNumStages() const;
+	};
+
+	// Sequence of functions known at compile time, applied in order and inlined into one body.
+	template <typename... TStages>
+	class Pipeline final
+	{
+	private:
+		std::tuple<TStages...> stages;
+
+	public:
+		constexpr explicit Pipeline(TStages... inStages)
+			: stages(std::move(inStages)...)
+		{
+		}
+
+		constexpr HReal operator() (HReal x) const
+		{
+			std::apply([&x](const TStages&... stage) { ((x = stage(x)), ...); }, stages);
+			return x;
+		}
+	};
+
+	template <typename... TStages>
+	constexpr Pipeline<std::decay_t<TStages>...> makePipeline(TStages&&... stages)
+	{
+		return Pipeline<std::decay_t<TStages>...>(std::forward<TStages>(stages)...);
+	}
+
 	class FunctionSequence
 	{
+	public:
+		// Inputs evaluated together by every function, before moving to the next tile.
+		static constexpr size_t TILE_SIZE = 1024;
+
 	private:
 		std::vector<TFunc1> functions;
+		std::vector<TBatchFunc1> batchFunctions;
+		std::vector<std::optional<AffineMap>> affineMaps;
+
+		friend class FrozenSequence;
+		friend class SequenceCache;
 
 	public:
 		FunctionSequence() = default;
@@ -19,18 +106,87 @@ namespace hmath
 		~FunctionSequence() = default;
 
 		void add(TFunc1 func);
+
+		// Adds scale * x + offset, which SequenceCache can precompose with adjacent affine maps.
+		void addAffine(HReal scale, HReal offset);
+
+		// Adds a function which the batch evaluation calls once per tile instead of once per input.
+		// outResults given to it doesn't overlap values.
+		void addBatch(TBatchFunc1 func);
+
 		void clear();
 		void empty();
 
+		// Snapshot of the current functions, of which copies share the stages.
+		FrozenSequence freeze() const;
+
 		TFunc1 asFunction() const;
 		HReal get(HReal x) const;
 		HReal getSub(HReal x, int start, int end) const;
 
+		// Applies function 0 to a tile of inputs, then function 1 to the tile, and so on,
+		// so that each function runs in a tight loop on data in cache.
+		// Batch stages are called once per tile, and affine stages are evaluated without a call.
+		// values and outResults may be the same.
+		void get(std::span<const HReal> values, std::span<HReal> outResults) const;
+		void getSub(std::span<const HReal> values, std::span<HReal> outResults, int start, int end) const;
+
 #if DO_TEST
 		static int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
 #endif // DO_TEST
 
 	private:
 		int truncateIndex(int index) const;
+		void applyTiled(size_t start, size_t end, std::span<const HReal> values, std::span<HReal> outResults) const;
+	};
+
+	inline HReal FrozenSequence::operator() (HReal x) const
+	{
+		if (sequence == nullptr)
+			return x;
+
+		const TFunc1* first = sequence->functions.data();
+		const TFunc1* last = first + sequence->functions.size();
+
+		for (const TFunc1* func = first; func != last; ++func)
+		{
+			x = (*func)(x);
+		}
+
+		return x;
+	}
+
+	// Answers many getSub queries on a snapshot of a FunctionSequence.
+	// record(x) stores the intermediate results of a full pass, and queries from x, matched by bit pattern,
+	// are answered from rows of stored results, one row per start index, extended on demand up to the queried end.
+	// Queries from other inputs use a segment tree of which nodes hold the composition of their stages
+	// when every stage is affine, so a range of affine stages costs O(log n).
+	// Results of composed affine maps may differ from stage-by-stage evaluation by rounding.
+	class SequenceCache final
+	{
+	private:
+		std::vector<TFunc1> functions;
+		std::vector<std::optional<AffineMap>> tree;
+		size_t numLeaves;
+
+		HReal recordedX;
+		std::vector<std::vector<HReal>> rows;
+
+	public:
+		explicit SequenceCache(const FunctionSequence& sequence);
+		~SequenceCache() = default;
+
+		void record(HReal x);
+
+		// Result of the first index stages from the recorded input.
+		HReal getIntermediate(int index) const;
+
+		HReal getSub(HReal x, int start, int end);
+
+		size_t getNumStages() const;
+
+	private:
+		int truncateIndex(int index) const;
+		HReal apply(size_t node, size_t nodeBegin, size_t nodeEnd, size_t start, size_t end, HReal x) const;
 	};
 } // hmath
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+
+namespace hmath
+{
+	// Contiguous container keeping up to InlineCapacity elements inside the object itself.
+	// It spills to the heap only when it grows beyond that, and never shrinks back.
+	template <typename T, size_t InlineCapacity>
+	class InlineBuffer final
+	{
+		static_assert(InlineCapacity > 0);
+		static_assert(std::is_trivially_copyable<T>::value);
+
+	public:
+		using value_type = T;
+		using size_type = size_t;
+		using iterator = T*;
+		using const_iterator = const T*;
+
+	private:
+		T* elements;
+		size_t count;
+		size_t capacityValue;
+		T inlineElements[InlineCapacity];
+
+	public:
+		InlineBuffer()
+			: elements(inlineElements), count(0), capacityValue(InlineCapacity)
+		{
+		}
+
+		InlineBuffer(size_t inCount, const T& value)
+			: InlineBuffer()
+		{
+			resize(inCount, value);
+		}
+
+		InlineBuffer(std::initializer_list<T> list)
+			: InlineBuffer(list.begin(), list.end())
+		{
+		}
+
+		template <typename TIterator>
+		InlineBuffer(TIterator first, TIterator last)
+			: InlineBuffer()
+		{
+			reserve(static_cast<size_t>(std::distance(first, last)));
+			count = static_cast<size_t>(std::copy(first, last, elements) - elements);
+		}
+
+		InlineBuffer(const InlineBuffer& rhs)
+			: InlineBuffer(rhs.begin(), rhs.end())
+		{
+		}
+
+		InlineBuffer(InlineBuffer&& rhs) noexcept
+			: InlineBuffer()
+		{
+			*this = std::move(rhs);
+		}
+
+		~InlineBuffer()
+		{
+			release();
+		}
+
+		InlineBuffer& operator= (const InlineBuffer& rhs)
+		{
+			if (this == &rhs)
+				return *this;
+
+			if (rhs.count > capacityValue)
+			{
+				release();
+				allocate(rhs.count);
+			}
+
+			count = static_cast<size_t>(std::copy(rhs.begin(), rhs.end(), elements) - elements);
+
+			return *this;
+		}
+
+		InlineBuffer& operator= (InlineBuffer&& rhs) noexcept
+		{
+			if (this == &rhs)
+				return *this;
+
+			if (!rhs.isInline())
+			{
+				release();
+
+				elements = rhs.elements;
+				count = rhs.count;
+				capacityValue = rhs.capacityValue;
+
+				rhs.elements = rhs.inlineElements;
+				rhs.capacityValue = InlineCapacity;
+				rhs.count = 0;
+
+				return *this;
+			}
+
+			// Inline elements can't be stolen, but they always fit in this buffer.
+			count = static_cast<size_t>(std::copy(rhs.begin(), rhs.end(), elements) - elements);
+			rhs.count = 0;
+
+			return *this;
+		}
+
+		bool operator== (const InlineBuffer& rhs) const
+		{
+			return std::equal(begin(), end(), rhs.begin(), rhs.end());
+		}
+
+		bool operator!= (const InlineBuffer& rhs) const
+		{
+			return !(*this == rhs);
+		}
+
+		T& operator[] (size_t index)
+		{
+			assert(index < count);
+			return elements[index];
+		}
+
+		const T& operator[] (size_t index) const
+		{
+			assert(index < count);
+			return elements[index];
+		}
+
+	public:
+		static constexpr size_t inlineCapacity() { return InlineCapacity; }
+
+		bool isInline() const { return elements == inlineElements; }
+		bool empty() const { return count == 0; }
+		size_t size() const { return count; }
+		size_t capacity() const { return capacityValue; }
+
+		T* data() { return elements; }
+		const T* data() const { return elements; }
+
+		iterator begin() { return elements; }
+		iterator end() { return elements + count; }
+		const_iterator begin() const { return elements; }
+		const_iterator end() const { return elements + count; }
+
+		T& at(size_t index)
+		{
+			assert(index < count);
+			return elements[index];
+		}
+
+		const T& at(size_t index) const
+		{
+			assert(index < count);
+			return elements[index];
+		}
+
+		T& back()
+		{
+			assert(count > 0);
+			return elements[count - 1];
+		}
+
+		const T& back() const
+		{
+			assert(count > 0);
+			return elements[count - 1];
+		}
+
+		void reserve(size_t newCapacity)
+		{
+			if (newCapacity <= capacityValue)
+				return;
+
+			T* oldElements = elements;
+			const size_t oldCapacity = capacityValue;
+			const bool bWasInline = isInline();
+
+			allocate(newCapacity);
+			std::copy(oldElements, oldElements + count, elements);
+
+			if (!bWasInline)
+			{
+				std::allocator<T>().deallocate(oldElements, oldCapacity);
+			}
+		}
+
+		// value may refer to an element of this buffer, so it's copied before growing frees the storage.
+		void resize(size_t newCount, const T& value = T())
+		{
+			if (newCount > count)
+			{
+				const T copied = value;
+				grow(newCount);
+				std::fill(elements + count, elements + newCount, copied);
+			}
+
+			count = newCount;
+		}
+
+		void clear()
+		{
+			count = 0;
+		}
+
+		void push_back(const T& value)
+		{
+			const T copied = value;
+			grow(count + 1);
+			elements[count++] = copied;
+		}
+
+		void pop_back()
+		{
+			assert(count > 0);
+			--count;
+		}
+
+		iterator insert(const_iterator position, size_t numElements, const T& value)
+		{
+			const size_t index = static_cast<size_t>(position - elements);
+			assert(index <= count);
+
+			// Growing may free value, and shifting may overwrite it.
+			const T copied = value;
+			grow(count + numElements);
+
+			std::copy_backward(elements + index, elements + count, elements + count + numElements);
+			std::fill(elements + index, elements + index + numElements, copied);
+			count += numElements;
+
+			return elements + index;
+		}
+
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			const size_t index = static_cast<size_t>(first - elements);
+			const size_t numElements = static_cast<size_t>(last - first);
+			assert(index + numElements <= count);
+
+			std::copy(elements + index + numElements, elements + count, elements + index);
+			count -= numElements;
+
+			return elements + index;
+		}
+
+	private:
+		void grow(size_t minCapacity)
+		{
+			if (minCapacity <= capacityValue)
+				return;
+
+			reserve(std::max(minCapacity, capacityValue * 2));
+		}
+
+		void allocate(size_t newCapacity)
+		{
+			elements = std::allocator<T>().allocate(newCapacity);
+			capacityValue = newCapacity;
+		}
+
+		void release()
+		{
+			if (!isInline())
+			{
+				std::allocator<T>().deallocate(elements, capacityValue);
+			}
+
+			elements = inlineElements;
+			capacityValue = InlineCapacity;
+		}
+	};
+}
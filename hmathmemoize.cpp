@@ -0,0 +1,249 @@
+#include "hmathmemoize.h"
+
+#include "hmathanalysis.h"
+#include "hmaththreadpool.h"
+#include "hmathutil.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+
+namespace hmath
+{
+
+namespace
+{
+	uint64_t getKey(HReal x)
+	{
+		uint64_t key = 0;
+		std::memcpy(&key, &x, sizeof(x));
+
+		return key;
+	}
+
+	// Finalizer of splitmix64, which mixes every bit of the key into every bit of the hash,
+	// so that keys with short mantissas, e.g. integers, spread over the slots as well.
+	uint64_t getHash(uint64_t key)
+	{
+		key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+		key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+
+		return key ^ (key >> 31);
+	}
+} // anonymous
+
+MemoizedFunction::MemoizedFunction(TFunc1 func, size_t capacity)
+	: state(std::make_shared<State>())
+{
+	if (!func)
+	{
+		using namespace std;
+		cerr << "[hmath][MemoizedFunction][Error] " << __func__ << ": func is null." << endl;
+	}
+
+	state->func = std::move(func);
+	state->numSlotsPerShard = std::bit_ceil(std::max<size_t>(1, (capacity + NUM_SHARDS - 1) / NUM_SHARDS));
+	state->numSlotBits = std::countr_zero(state->numSlotsPerShard);
+	state->numHits = 0;
+	state->numMisses = 0;
+
+	for (auto& shard : state->shards)
+	{
+		shard.slots.resize(state->numSlotsPerShard, Slot{ 0, 0, false });
+	}
+}
+
+HReal MemoizedFunction::operator() (HReal x) const
+{
+	if (!state->func)
+		return 0;
+
+	const uint64_t key = getKey(x);
+	const uint64_t hash = getHash(key);
+
+	static_assert(NUM_SHARDS == 16, "The shard is chosen by the top 4 bits of the hash.");
+
+	// The slot is chosen by the bits right below the shard bits.
+	Shard& shard = state->shards[hash >> 60];
+	Slot& slot = shard.slots[(hash >> (60 - state->numSlotBits)) & (state->numSlotsPerShard - 1)];
+
+	{
+		std::lock_guard lock(shard.mutex);
+
+		if (slot.bValid && slot.key == key)
+		{
+			state->numHits.fetch_add(1, std::memory_order_relaxed);
+			return slot.value;
+		}
+	}
+
+	state->numMisses.fetch_add(1, std::memory_order_relaxed);
+
+	const HReal value = state->func(x);
+
+	{
+		std::lock_guard lock(shard.mutex);
+
+		slot.key = key;
+		slot.value = value;
+		slot.bValid = true;
+	}
+
+	return value;
+}
+
+uint64_t MemoizedFunction::getNumHits() const
+{
+	return state->numHits.load();
+}
+
+uint64_t MemoizedFunction::getNumMisses() const
+{
+	return state->numMisses.load();
+}
+
+size_t MemoizedFunction::getCapacity() const
+{
+	return state->numSlotsPerShard * NUM_SHARDS;
+}
+
+void MemoizedFunction::clear()
+{
+	for (auto& shard : state->shards)
+	{
+		std::lock_guard lock(shard.mutex);
+
+		for (auto& slot : shard.slots)
+		{
+			slot.bValid = false;
+		}
+	}
+
+	state->numHits = 0;
+	state->numMisses = 0;
+}
+
+#if DO_TEST
+int MemoizedFunction::DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
+{
+	using namespace std;
+
+	int errorCount = 0;
+
+	auto report = [&](int line, const string& text)
+	{
+		++errorCount;
+
+		ostringstream msg;
+		msg << "[MemoizedFunction][TC" << inOutTestCount << "][Error] " << line << ": " << text << endl;
+
+		const auto errorMsg = msg.view();
+		cerr << errorMsg;
+
+		outErrorMessages.emplace_back(errorMsg);
+	};
+
+	std::atomic<int> numCalls = 0;
+	const TFunc1 func = [&numCalls](HReal x) -> HReal
+	{
+		++numCalls;
+		return std::exp(x) - 2 * std::cos(x);
+	};
+
+	{
+		cout << endl << "[MemoizedFunction][TC" << ++inOutTestCount << "] Memoized analysis" << endl;
+
+		MemoizedFunction memoized(func);
+
+		// The second-order derivative evaluates func(x) twice, and repeated solves revisit every point.
+		const HReal ddy = analysis::secondOrderDerivative(memoized, 0.5);
+		const HReal trueDdy = analysis::secondOrderDerivative(func, 0.5);
+
+		int count = 0;
+		for (int i = 0; i < 9; ++i)
+		{
+			analysis::newtonRaphsonMethod(count, memoized, 2.0);
+		}
+
+		const auto root = analysis::newtonRaphsonMethod(count, memoized, 2.0);
+
+		cout << "[MemoizedFunction][TC" << inOutTestCount << "] hits = " << memoized.getNumHits()
+			<< ", misses = " << memoized.getNumMisses() << ", root = " << (root ? root->value : NAN) << endl;
+
+		if (ddy != trueDdy || !root || memoized.getNumHits() == 0
+			|| memoized.getNumHits() + memoized.getNumMisses() <= memoized.getNumMisses() * 5)
+		{
+			report(__LINE__, "memoization doesn't save evaluations, hits = " + to_string(memoized.getNumHits())
+				+ ", misses = " + to_string(memoized.getNumMisses()));
+		}
+
+		memoized.clear();
+		if (memoized.getNumHits() != 0 || memoized.getNumMisses() != 0)
+		{
+			report(__LINE__, "clear SHOULD reset the counters.");
+		}
+	}
+
+	{
+		cout << endl << "[MemoizedFunction][TC" << ++inOutTestCount << "] Concurrent memoization" << endl;
+
+		MemoizedFunction memoized(func, 1 << 16);
+		const TFunc1 copied = memoized;
+
+		ThreadPool pool(4);
+
+		numCalls = 0;
+		const auto error = util::compare(pool, memoized, func, -1, 1, 1e-4);
+		const int firstCalls = numCalls.load();
+
+		// Copies share the cache, so the points are hits now, except the ones evicted by collisions.
+		const auto secondError = util::compare(pool, copied, memoized, -1, 1, 1e-4);
+		const int secondCalls = numCalls.load() - firstCalls;
+
+		cout << "[MemoizedFunction][TC" << inOutTestCount << "] capacity = " << memoized.getCapacity()
+			<< ", hits = " << memoized.getNumHits() << ", misses = " << memoized.getNumMisses()
+			<< ", calls = " << firstCalls << " then " << secondCalls << endl;
+
+		if (error != 0 || secondError != 0 || memoized.getNumHits() == 0 || secondCalls >= firstCalls / 2)
+		{
+			report(__LINE__, "concurrent memoization failed, error = " + to_string(error)
+				+ ", calls = " + to_string(firstCalls) + " then " + to_string(secondCalls));
+		}
+	}
+
+	{
+		cout << endl << "[MemoizedFunction][TC" << ++inOutTestCount << "] Keys with short mantissas" << endl;
+
+		// Integers and dyadic values have zeros in every low bit of the key.
+		for (const HReal scale : { ONE, ONE / 1024 })
+		{
+			MemoizedFunction memoized(func);
+
+			constexpr int numKeys = 1000;
+			for (int repeat = 0; repeat < 2; ++repeat)
+			{
+				for (int i = 0; i < numKeys; ++i)
+				{
+					memoized(i * scale);
+				}
+			}
+
+			cout << "[MemoizedFunction][TC" << inOutTestCount << "] keys i * " << scale << ": hits = "
+				<< memoized.getNumHits() << " of " << numKeys << endl;
+
+			// A key is kept if no other key shares its slot, e^(-1000 / 4096), about 78% of the keys.
+			if (memoized.getNumHits() < numKeys * 7 / 10)
+			{
+				report(__LINE__, "keys i * " + to_string(scale) + " collide, hits = " + to_string(memoized.getNumHits()));
+			}
+		}
+	}
+
+	return errorCount;
+}
+#endif // DO_TEST
+
+} // hmath
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "hmathconfig.h"
+#include "hmathtypes.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace hmath
+{
+	// Opt-in memoization of an expensive function, keyed on the exact bits of the input.
+	// The cache is bounded and split into shards of direct-mapped slots, each locked by its own mutex
+	// only while a slot is read or written, so concurrent callers rarely wait and the function runs unlocked.
+	// A new value replaces the one in its slot.
+	// Copies share the cache, so that it can be passed as a TFunc1 or a FunctionRef.
+	// The function should be pure, as a hit skips calling it.
+	class MemoizedFunction final
+	{
+	public:
+		static constexpr size_t NUM_SHARDS = 16;
+		static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+	private:
+		struct Slot final
+		{
+			uint64_t key;
+			HReal value;
+			bool bValid;
+		};
+
+		struct Shard final
+		{
+			std::mutex mutex;
+			std::vector<Slot> slots;
+		};
+
+		struct State final
+		{
+			TFunc1 func;
+			std::array<Shard, NUM_SHARDS> shards;
+			size_t numSlotsPerShard;
+			int numSlotBits;
+			std::atomic<uint64_t> numHits;
+			std::atomic<uint64_t> numMisses;
+		};
+
+		std::shared_ptr<State> state;
+
+	public:
+		// The capacity is rounded up to NUM_SHARDS times a power of two.
+		explicit MemoizedFunction(TFunc1 func, size_t capacity = DEFAULT_CAPACITY);
+		~MemoizedFunction() = default;
+
+		HReal operator() (HReal x) const;
+
+		uint64_t getNumHits() const;
+		uint64_t getNumMisses() const;
+		size_t getCapacity() const;
+
+		// Forgets every value and resets the counters.
+		void clear();
+
+#if DO_TEST
+		static int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
+#endif // DO_TEST
+	};
+} // hmath
@@ -1,46 +1,355 @@
 #include "hmathpolynomial.h"
 
+#include "hmath.h"
 #include "hmathanalysis.h"
+#include "hmathfunctionref.h"
+#include "hmathstaticpolynomial.h"
 #include "hmathutil.h"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <complex>
 #include <iostream>
 #include <sstream>
 
+#if USE_SIMD && (defined(__AVX2__) || defined(__AVX512F__))
+#include <immintrin.h>
+#endif // USE_SIMD
+
 
 namespace hmath
 {
-    Polynomial::Polynomial(std::initializer_list<HReal> inCoefficients)
-        : coefficients(inCoefficients)
+    namespace
     {
+        // Number of values evaluated together by the portable path.
+        // Independent lanes let the compiler vectorize and hide the multiply-add latency.
+        constexpr size_t EVALUATION_LANES = 8;
+
+        // Number of coefficients reduced at once by Estrin's scheme, should be a power of two.
+        constexpr size_t ESTRIN_BLOCK_SIZE = 256;
+
+        // Estrin's scheme on at most ESTRIN_BLOCK_SIZE coefficients in descending order.
+        // Each level pairs up independent terms, so the multiply-add chain is logarithmic in count.
+        HReal evaluateEstrinBlock(const HReal* coeffs, size_t count, HReal x)
+        {
+            assert(count <= ESTRIN_BLOCK_SIZE);
+
+            if (count == 0)
+                return ZERO;
+
+            // The first level reads the coefficients from the constant term upwards.
+            HReal buffer[ESTRIN_BLOCK_SIZE / 2 + 1];
+            const HReal* lastCoeff = coeffs + (count - 1);
+
+            size_t half = count / 2;
+            for (size_t i = 0; i < half; ++i)
+            {
+                buffer[i] = lastCoeff[-static_cast<ptrdiff_t>(2 * i)]
+                    + lastCoeff[-static_cast<ptrdiff_t>(2 * i + 1)] * x;
+            }
+
+            // The leading coefficient stands alone when count is odd, and is past the used entries otherwise.
+            buffer[half] = coeffs[0];
+
+            size_t size = half + count % 2;
+            HReal power = x * x;
+
+            while (size > 1)
+            {
+                half = size / 2;
+                for (size_t i = 0; i < half; ++i)
+                {
+                    buffer[i] = buffer[2 * i] + buffer[2 * i + 1] * power;
+                }
+
+                if (size % 2 != 0)
+                {
+                    buffer[half] = buffer[size - 1];
+                }
+
+                size = half + size % 2;
+                power = power * power;
+            }
+
+            return buffer[0];
+        }
+
+        // Convolution kernels. Each adds the product of a and b into out, which has na + nb - 1 elements.
+        // The convolution doesn't depend on the order of coefficients, so they work on the descending order as is.
+        void multiplyAccumulateDirect(const HReal* a, size_t na, const HReal* b, size_t nb, HReal* out)
+        {
+            for (size_t i = 0; i < na; ++i)
+            {
+                const HReal coeff = a[i];
+                HReal* row = out + i;
+
+                for (size_t j = 0; j < nb; ++j)
+                {
+                    row[j] += coeff * b[j];
+                }
+            }
+        }
+
+        // Scratch elements multiplyAccumulateKaratsuba needs for the operands, following its recursion.
+        size_t getKaratsubaScratchSize(size_t na, size_t nb)
+        {
+            if (na < nb)
+            {
+                std::swap(na, nb);
+            }
+
+            if (nb < static_cast<size_t>(Polynomial::KARATSUBA_THRESHOLD))
+                return 0;
+
+            const size_t half = (na + 1) / 2;
+
+            if (nb <= half)
+                return std::max(getKaratsubaScratchSize(nb, nb), getKaratsubaScratchSize(na % nb, nb));
+
+            const size_t na1 = na - half;
+            const size_t nb1 = nb - half;
+
+            // sumA, sumB, low, middle and high, followed by the scratch of the recursions, which run one by one.
+            const size_t ownSize = 2 * half + 2 * (2 * half - 1) + (na1 + nb1 - 1);
+            return ownSize + std::max(getKaratsubaScratchSize(half, half), getKaratsubaScratchSize(na1, nb1));
+        }
+
+        // scratch has at least getKaratsubaScratchSize(na, nb) elements.
+        void multiplyAccumulateKaratsuba(const HReal* a, size_t na, const HReal* b, size_t nb, HReal* out, HReal* scratch)
+        {
+            if (na < nb)
+            {
+                std::swap(a, b);
+                std::swap(na, nb);
+            }
+
+            if (nb < static_cast<size_t>(Polynomial::KARATSUBA_THRESHOLD))
+            {
+                multiplyAccumulateDirect(a, na, b, nb, out);
+                return;
+            }
+
+            const size_t half = (na + 1) / 2;
+
+            // Unbalanced operands, a is multiplied by b chunk by chunk.
+            if (nb <= half)
+            {
+                for (size_t offset = 0; offset < na; offset += nb)
+                {
+                    const size_t chunkSize = std::min(nb, na - offset);
+                    multiplyAccumulateKaratsuba(a + offset, chunkSize, b, nb, out + offset, scratch);
+                }
+
+                return;
+            }
+
+            // a = a0 + a1 * t, b = b0 + b1 * t, where a0 and b0 have half elements.
+            const HReal* a0 = a;
+            const HReal* a1 = a + half;
+            const HReal* b0 = b;
+            const HReal* b1 = b + half;
+            const size_t na1 = na - half;
+            const size_t nb1 = nb - half;
+
+            const size_t lowSize = 2 * half - 1;
+            const size_t highSize = na1 + nb1 - 1;
+
+            HReal* sumA = scratch;
+            HReal* sumB = sumA + half;
+            HReal* low = sumB + half;
+            HReal* middle = low + lowSize;
+            HReal* high = middle + lowSize;
+            HReal* nextScratch = high + highSize;
+
+            std::copy_n(a0, half, sumA);
+            std::copy_n(b0, half, sumB);
+
+            for (size_t i = 0; i < na1; ++i)
+            {
+                sumA[i] += a1[i];
+            }
+
+            for (size_t i = 0; i < nb1; ++i)
+            {
+                sumB[i] += b1[i];
+            }
+
+            std::fill_n(low, 2 * lowSize + highSize, ZERO);
+
+            multiplyAccumulateKaratsuba(a0, half, b0, half, low, nextScratch);
+            multiplyAccumulateKaratsuba(a1, na1, b1, nb1, high, nextScratch);
+            multiplyAccumulateKaratsuba(sumA, half, sumB, half, middle, nextScratch);
+
+            for (size_t i = 0; i < lowSize; ++i)
+            {
+                middle[i] -= low[i];
+                out[i] += low[i];
+            }
+
+            for (size_t i = 0; i < highSize; ++i)
+            {
+                middle[i] -= high[i];
+                out[2 * half + i] += high[i];
+            }
+
+            for (size_t i = 0; i < lowSize; ++i)
+            {
+                out[half + i] += middle[i];
+            }
+        }
+
+        // Iterative radix-2 FFT, values.size() should be a power of two.
+        void transformFFT(std::vector<std::complex<HReal>>& values, bool bInverse,
+            std::vector<std::complex<HReal>>& twiddles)
+        {
+            using TComplex = std::complex<HReal>;
+
+            const size_t size = values.size();
+            assert(std::has_single_bit(size));
+
+            for (size_t i = 1, j = 0; i < size; ++i)
+            {
+                size_t bit = size >> 1;
+                for (; (j & bit) != 0; bit >>= 1)
+                {
+                    j ^= bit;
+                }
+
+                j ^= bit;
+
+                if (i < j)
+                {
+                    std::swap(values[i], values[j]);
+                }
+            }
+
+            const HReal sign = bInverse ? ONE : MINUS_ONE;
+
+            twiddles.resize(size / 2);
+            for (size_t i = 0; i < twiddles.size(); ++i)
+            {
+                twiddles[i] = std::polar(ONE, sign * TWO_PI * i / size);
+            }
+
+            for (size_t length = 2; length <= size; length <<= 1)
+            {
+                const size_t halfLength = length / 2;
+                const size_t stride = size / length;
+
+                for (size_t start = 0; start < size; start += length)
+                {
+                    for (size_t k = 0; k < halfLength; ++k)
+                    {
+                        const TComplex even = values[start + k];
+                        const TComplex odd = values[start + k + halfLength] * twiddles[k * stride];
+
+                        values[start + k] = even + odd;
+                        values[start + k + halfLength] = even - odd;
+                    }
+                }
+            }
+        }
+
+        void multiplyAccumulateFFT(const HReal* a, size_t na, const HReal* b, size_t nb, HReal* out,
+            Polynomial::Workspace& workspace)
+        {
+            using TComplex = std::complex<HReal>;
+
+            const size_t resultSize = na + nb - 1;
+            const size_t size = std::bit_ceil(resultSize);
+
+            auto& fa = workspace.fftLhs;
+            auto& fb = workspace.fftRhs;
+
+            fa.assign(size, TComplex());
+            fb.assign(size, TComplex());
+
+            std::copy_n(a, na, fa.begin());
+            std::copy_n(b, nb, fb.begin());
+
+            transformFFT(fa, false, workspace.twiddles);
+            transformFFT(fb, false, workspace.twiddles);
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                fa[i] *= fb[i];
+            }
+
+            transformFFT(fa, true, workspace.twiddles);
+
+            const HReal scale = ONE / size;
+            for (size_t i = 0; i < resultSize; ++i)
+            {
+                out[i] += fa[i].real() * scale;
+            }
+        }
     }
 
-    Polynomial::Polynomial(const std::vector<HReal>& inCoefficients)
+    Polynomial::Polynomial(std::initializer_list<HReal> inCoefficients)
         : coefficients(inCoefficients)
     {
     }
 
-	Polynomial::Polynomial(std::vector<HReal>&& inCoefficients)
-        : coefficients(std::move(inCoefficients))
+    Polynomial::Polynomial(const std::vector<HReal>& inCoefficients)
+        : coefficients(inCoefficients.begin(), inCoefficients.end())
     {
     }
 
     Polynomial::Polynomial(TFunc1 smoothFunc, HReal point, int depth, HReal epsilon)
     {
-        // Taylor Series at the given point
-        auto y = smoothFunc;
-        auto dy = analysis::getDerivative(y, epsilon);
+        if (!smoothFunc)
+        {
+            using namespace std;
+            cerr << "[Polynomial][Error] ctor: smoothFunc is null." << endl;
+            return;
+        }
 
-        coefficients.reserve(depth);
-        
-        for (int i = 0; i < depth; ++i)
+        assert(epsilon > 0);
+
+        // Taylor Series at the given point.
+        // The k-th derivative is the k-th central difference, one stencil of k + 1 samples per order,
+        // instead of nesting derivative functions, of which cost grows exponentially with depth.
+        std::vector<HReal> taylorCoefficients;
+        taylorCoefficients.reserve(std::max(depth, 0));
+
+        const HReal scale = std::max(ONE, analysis::getError(point, ZERO));
+        HReal factorial = ONE;
+
+        for (int order = 0; order < depth; ++order)
         {
-            
+            if (order == 0)
+            {
+                taylorCoefficients.push_back(smoothFunc(point));
+                continue;
+            }
+
+            factorial *= order;
+
+            // Rounding error grows as h^-order, so the step widens with the order.
+            const HReal step = std::max(epsilon, std::pow(MACHINE_EPSILON, ONE / (order + 2))) * scale;
+
+            HReal sum = ZERO;
+            HReal binomial = ONE;
+
+            for (int j = 0; j <= order; ++j)
+            {
+                const HReal x = point + (HALF * order - j) * step;
+                const HReal sign = (j % 2 == 0) ? ONE : MINUS_ONE;
+
+                sum += sign * binomial * smoothFunc(x);
+                binomial = binomial * (order - j) / (j + 1);
+            }
+
+            taylorCoefficients.push_back(sum / (std::pow(step, order) * factorial));
         }
+
+        setTaylorSeries(taylorCoefficients, point);
     }
 
-    Polynomial Polynomial::operator+ (const Polynomial& rhs) const
+    Polynomial Polynomial::operator+ (const Polynomial& rhs) const&
     {
         TOrder sizeDiff = numCoefficients() - rhs.numCoefficients();
 
@@ -83,7 +392,7 @@ namespace hmath
         return outcome;
     }
 
-    Polynomial Polynomial::operator- (const Polynomial& rhs) const
+    Polynomial Polynomial::operator- (const Polynomial& rhs) const&
     {
         TOrder sizeDiff = numCoefficients() - rhs.numCoefficients();
 
@@ -131,30 +440,62 @@ namespace hmath
         return outcome;
     }
 
-    Polynomial Polynomial::operator* (const Polynomial& rhs) const
+    Polynomial Polynomial::operator+ (const Polynomial& rhs) &&
     {
-        Polynomial result;
+        *this += rhs;
+        return std::move(*this);
+    }
 
-        TOrder sizeRhs = rhs.numCoefficients();
-        TOrder orderRhs = sizeRhs - 1;
+    Polynomial Polynomial::operator+ (Polynomial&& rhs) const&
+    {
+        rhs += *this;
+        return std::move(rhs);
+    }
 
-        for (TOrder i = 0; i < sizeRhs; ++i)
+    Polynomial Polynomial::operator+ (Polynomial&& rhs) &&
+    {
+        if (coefficients.capacity() < rhs.coefficients.capacity())
         {
-            const TOrder exponent = orderRhs - i;
-            assert(exponent >= 0);
+            rhs += *this;
+            return std::move(rhs);
+        }
 
-            auto coeff = rhs.getCoefficient(i);
-            Polynomial tmp(*this);
-            tmp *= coeff;
-            tmp.shiftUp(exponent);
+        *this += rhs;
+        return std::move(*this);
+    }
 
-            result = result + tmp;
+    Polynomial Polynomial::operator- (const Polynomial& rhs) &&
+    {
+        *this -= rhs;
+        return std::move(*this);
+    }
+
+    Polynomial Polynomial::operator- (Polynomial&& rhs) const&
+    {
+        rhs *= MINUS_ONE;
+        rhs += *this;
+        return std::move(rhs);
+    }
+
+    Polynomial Polynomial::operator- (Polynomial&& rhs) &&
+    {
+        if (coefficients.capacity() < rhs.coefficients.capacity())
+        {
+            rhs *= MINUS_ONE;
+            rhs += *this;
+            return std::move(rhs);
         }
 
-        return result;
+        *this -= rhs;
+        return std::move(*this);
+    }
+
+    Polynomial Polynomial::operator* (const Polynomial& rhs) const
+    {
+        return multiply(rhs);
     }
     
-    Polynomial Polynomial::operator* (HReal value) const
+    Polynomial Polynomial::operator* (HReal value) const&
     {
         Polynomial result(*this);
         result *= value;
@@ -162,12 +503,434 @@ namespace hmath
         return result;
     }
 
-    void Polynomial::operator*= (HReal value)
+    Polynomial Polynomial::operator* (HReal value) &&
+    {
+        *this *= value;
+        return std::move(*this);
+    }
+
+    Polynomial& Polynomial::operator+= (const Polynomial& rhs)
+    {
+        const size_t rhsSize = rhs.coefficients.size();
+        if (rhsSize > coefficients.size())
+        {
+            // Higher order terms come first, so the new terms are inserted at the front.
+            coefficients.insert(coefficients.begin(), rhsSize - coefficients.size(), ZERO);
+        }
+
+        const size_t offset = coefficients.size() - rhsSize;
+        for (size_t i = 0; i < rhsSize; ++i)
+        {
+            coefficients[offset + i] += rhs.coefficients[i];
+        }
+
+        return *this;
+    }
+
+    Polynomial& Polynomial::operator-= (const Polynomial& rhs)
+    {
+        const size_t rhsSize = rhs.coefficients.size();
+        if (rhsSize > coefficients.size())
+        {
+            coefficients.insert(coefficients.begin(), rhsSize - coefficients.size(), ZERO);
+        }
+
+        const size_t offset = coefficients.size() - rhsSize;
+        for (size_t i = 0; i < rhsSize; ++i)
+        {
+            coefficients[offset + i] -= rhs.coefficients[i];
+        }
+
+        return *this;
+    }
+
+    Polynomial& Polynomial::operator*= (const Polynomial& rhs)
+    {
+        const size_t na = coefficients.size();
+        const size_t nb = rhs.coefficients.size();
+
+        if (na == 0 || nb == 0)
+        {
+            coefficients.clear();
+            return *this;
+        }
+
+        if (this == &rhs || std::min(na, nb) >= static_cast<size_t>(KARATSUBA_THRESHOLD))
+        {
+            *this = multiply(rhs);
+            return *this;
+        }
+
+        // In-place direct convolution from the last coefficient backwards.
+        // c[k] only reads a[i] for i <= k, which are not overwritten yet.
+        coefficients.resize(na + nb - 1, ZERO);
+
+        HReal* a = coefficients.data();
+        const HReal* b = rhs.coefficients.data();
+
+        for (size_t k = na + nb - 1; k-- > 0;)
+        {
+            const size_t first = k >= nb ? k - nb + 1 : 0;
+            const size_t last = std::min(k, na - 1);
+
+            HReal sum = ZERO;
+            for (size_t i = first; i <= last; ++i)
+            {
+                sum += a[i] * b[k - i];
+            }
+
+            a[k] = sum;
+        }
+
+        return *this;
+    }
+
+    Polynomial& Polynomial::operator*= (HReal value)
     {
         for (auto& coeff : coefficients)
         {
             coeff *= value;
         }
+
+        return *this;
+    }
+
+    Polynomial Polynomial::multiply(const Polynomial& rhs, MultiplicationMethod method) const
+    {
+        Polynomial outcome;
+        Workspace workspace;
+        multiply(rhs, outcome, workspace, method);
+
+        return outcome;
+    }
+
+    void Polynomial::multiply(const Polynomial& rhs, Polynomial& outProduct, Workspace& workspace,
+        MultiplicationMethod method) const
+    {
+        if (&outProduct == this || &outProduct == &rhs)
+        {
+            outProduct = multiply(rhs, method);
+            return;
+        }
+
+        const size_t na = coefficients.size();
+        const size_t nb = rhs.coefficients.size();
+
+        outProduct.coefficients.clear();
+
+        if (na == 0 || nb == 0)
+            return;
+
+        const size_t resultSize = na + nb - 1;
+
+        if (method == MultiplicationMethod::Auto)
+        {
+            if (std::min(na, nb) < static_cast<size_t>(KARATSUBA_THRESHOLD))
+            {
+                method = MultiplicationMethod::Direct;
+            }
+            else if (resultSize < static_cast<size_t>(FFT_THRESHOLD))
+            {
+                method = MultiplicationMethod::Karatsuba;
+            }
+            else
+            {
+                method = MultiplicationMethod::FFT;
+            }
+        }
+
+        outProduct.coefficients.resize(resultSize, ZERO);
+
+        HReal* result = outProduct.coefficients.data();
+        const HReal* a = coefficients.data();
+        const HReal* b = rhs.coefficients.data();
+
+        switch (method)
+        {
+        case MultiplicationMethod::Karatsuba:
+            workspace.scratch.resize(getKaratsubaScratchSize(na, nb));
+            multiplyAccumulateKaratsuba(a, na, b, nb, result, workspace.scratch.data());
+            break;
+
+        case MultiplicationMethod::FFT:
+            multiplyAccumulateFFT(a, na, b, nb, result, workspace);
+            break;
+
+        default:
+            multiplyAccumulateDirect(a, na, b, nb, result);
+            break;
+        }
+    }
+
+    void Polynomial::divide(const Polynomial& divisor, Polynomial& outQuotient, Polynomial& outRemainder) const
+    {
+        Workspace workspace;
+        divide(divisor, &outQuotient, outRemainder, workspace, DivisionMethod::Auto);
+    }
+
+    void Polynomial::divide(const Polynomial& divisor, Polynomial& outQuotient, Polynomial& outRemainder,
+        Workspace& workspace, DivisionMethod method) const
+    {
+        divide(divisor, &outQuotient, outRemainder, workspace, method);
+    }
+
+    void Polynomial::remainder(const Polynomial& divisor, Polynomial& outRemainder) const
+    {
+        Workspace workspace;
+        divide(divisor, nullptr, outRemainder, workspace, DivisionMethod::Auto);
+    }
+
+    void Polynomial::remainder(const Polynomial& divisor, Polynomial& outRemainder,
+        Workspace& workspace, DivisionMethod method) const
+    {
+        divide(divisor, nullptr, outRemainder, workspace, method);
+    }
+
+    void Polynomial::divide(const Polynomial& divisor, Polynomial* outQuotient, Polynomial& outRemainder,
+        Workspace& workspace, DivisionMethod method) const
+    {
+        if (outQuotient == &outRemainder)
+        {
+            using namespace std;
+            cerr << "[Polynomial][Error] " << __func__ << ": the quotient and the remainder are the same object." << endl;
+
+            return;
+        }
+
+        if (&divisor == outQuotient || &divisor == &outRemainder)
+        {
+            const Polynomial copied = divisor;
+            divide(copied, outQuotient, outRemainder, workspace, method);
+
+            return;
+        }
+
+        const size_t divisorSize = divisor.coefficients.size();
+        const HReal* b = divisor.coefficients.data();
+
+        size_t lead = 0;
+        while (lead < divisorSize && b[lead] == ZERO)
+        {
+            ++lead;
+        }
+
+        if (lead == divisorSize)
+        {
+            using namespace std;
+            cerr << "[Polynomial][Error] " << __func__ << ": division by zero polynomial." << endl;
+
+            if (outQuotient != nullptr)
+            {
+                outQuotient->coefficients.clear();
+            }
+
+            outRemainder.coefficients.clear();
+            return;
+        }
+
+        b += lead;
+        const size_t nb = divisorSize - lead;
+        const size_t na = coefficients.size();
+        const size_t numQuotient = na >= nb ? na - nb + 1 : 0;
+
+        if (method == DivisionMethod::Auto)
+        {
+            const bool bLarge = std::min(numQuotient, nb) >= static_cast<size_t>(NEWTON_DIVISION_THRESHOLD);
+            method = bLarge ? DivisionMethod::Newton : DivisionMethod::Long;
+        }
+
+        if (method == DivisionMethod::Newton && numQuotient > 0)
+        {
+            divideNewton(b, nb, outQuotient, outRemainder, workspace);
+            return;
+        }
+
+        outRemainder.coefficients = coefficients;
+
+        // The quotient overwrites the leading coefficients as they are eliminated,
+        // leaving the remainder in the last nb - 1 coefficients.
+        HReal* r = outRemainder.coefficients.data();
+
+        for (size_t i = 0; i < numQuotient; ++i)
+        {
+            const HReal q = r[i] / b[0];
+            r[i] = q;
+
+            for (size_t j = 1; j < nb; ++j)
+            {
+                r[i + j] -= q * b[j];
+            }
+        }
+
+        if (outQuotient != nullptr)
+        {
+            outQuotient->coefficients.resize(numQuotient);
+            std::copy_n(r, numQuotient, outQuotient->coefficients.data());
+        }
+
+        outRemainder.coefficients.erase(outRemainder.coefficients.begin(),
+            outRemainder.coefficients.begin() + numQuotient);
+        outRemainder.trim();
+    }
+
+    void Polynomial::divideNewton(const HReal* divisor, size_t divisorSize, Polynomial* outQuotient,
+        Polynomial& outRemainder, Workspace& workspace) const
+    {
+        // Coefficients in descending order read in ascending order are the ones of the reversal x^n p(1 / x),
+        // and rev(quotient) = rev(this) / rev(divisor) mod x^m, where m is the number of quotient coefficients.
+        // The reciprocal of rev(divisor) is refined by g = g (2 - rev(divisor) g) mod x^2k, doubling the precision k,
+        // so that the division costs a few fast multiplications.
+        const size_t na = coefficients.size();
+        const size_t nb = divisorSize;
+        const size_t m = na - nb + 1;
+
+        auto& inverse = workspace.inverse.coefficients;
+        auto& truncated = workspace.truncated.coefficients;
+
+        inverse.resize(1);
+        inverse[0] = ONE / divisor[0];
+
+        for (size_t k = 1; k < m;)
+        {
+            const size_t nextK = std::min(2 * k, m);
+
+            truncated.resize(std::min(nb, nextK));
+            std::copy_n(divisor, truncated.size(), truncated.data());
+
+            workspace.truncated.multiply(workspace.inverse, workspace.product, workspace);
+
+            auto& error = workspace.product.coefficients;
+            error.resize(nextK, ZERO);
+
+            for (auto& coeff : error)
+            {
+                coeff = -coeff;
+            }
+
+            error[0] += TWO;
+
+            // The quotient is free until the iteration ends, so it holds the product for a moment.
+            // Copying back rather than swapping keeps the capacity of each buffer for the next division.
+            workspace.inverse.multiply(workspace.product, workspace.quotient, workspace);
+            inverse.resize(nextK);
+            std::copy_n(workspace.quotient.coefficients.data(), nextK, inverse.data());
+
+            k = nextK;
+        }
+
+        truncated.resize(m);
+        std::copy_n(coefficients.data(), m, truncated.data());
+
+        workspace.truncated.multiply(workspace.inverse, workspace.quotient, workspace);
+        workspace.quotient.coefficients.resize(m);
+
+        // remainder = this - quotient * divisor, of which the leading m coefficients cancel out.
+        truncated.resize(nb);
+        std::copy_n(divisor, nb, truncated.data());
+
+        workspace.quotient.multiply(workspace.truncated, workspace.product, workspace);
+
+        HReal* product = workspace.product.coefficients.data();
+        for (size_t i = m; i < na; ++i)
+        {
+            product[i] = coefficients[i] - product[i];
+        }
+
+        outRemainder.coefficients.resize(nb - 1);
+        std::copy_n(product + m, nb - 1, outRemainder.coefficients.data());
+        outRemainder.trim();
+
+        if (outQuotient != nullptr)
+        {
+            *outQuotient = workspace.quotient;
+        }
+    }
+
+    HReal Polynomial::deflate(HReal root)
+    {
+        const size_t count = coefficients.size();
+        if (count == 0)
+            return ZERO;
+
+        // Horner's method, of which the partial sums are the coefficients of the quotient.
+        HReal* coeffs = coefficients.data();
+        for (size_t i = 1; i < count; ++i)
+        {
+            coeffs[i] += root * coeffs[i - 1];
+        }
+
+        const HReal remainder = coeffs[count - 1];
+        coefficients.pop_back();
+
+        return remainder;
+    }
+
+    void Polynomial::gcd(const Polynomial& lhs, const Polynomial& rhs, Polynomial& outGcd,
+        Workspace& workspace, HReal tolerance)
+    {
+        // The roles of the three polynomials rotate, so that no coefficients are moved between steps.
+        Polynomial* dividend = &workspace.lhs;
+        Polynomial* divisor = &workspace.rhs;
+        Polynomial* remainder = &workspace.product;
+
+        *dividend = lhs;
+        *divisor = rhs;
+
+        for (Polynomial* polynomial : { dividend, divisor })
+        {
+            polynomial->trim();
+            polynomial->normalize();
+        }
+
+        if (dividend->numCoefficients() < divisor->numCoefficients())
+        {
+            std::swap(dividend, divisor);
+        }
+
+        // Remainders are normalized, so the tolerance is relative to the largest coefficient.
+        while (divisor->numCoefficients() > 0)
+        {
+            dividend->divide(*divisor, nullptr, *remainder, workspace, DivisionMethod::Long);
+            remainder->trim(tolerance);
+            remainder->normalize();
+
+            Polynomial* const lastDividend = dividend;
+            dividend = divisor;
+            divisor = remainder;
+            remainder = lastDividend;
+        }
+
+        outGcd = *dividend;
+
+        if (outGcd.numCoefficients() > 0)
+        {
+            outGcd *= ONE / outGcd.coefficients[0];
+        }
+    }
+
+    void Polynomial::trim(HReal tolerance)
+    {
+        size_t numLeadingZeros = 0;
+        while (numLeadingZeros < coefficients.size() && std::abs(coefficients[numLeadingZeros]) <= tolerance)
+        {
+            ++numLeadingZeros;
+        }
+
+        coefficients.erase(coefficients.begin(), coefficients.begin() + numLeadingZeros);
+    }
+
+    void Polynomial::normalize()
+    {
+        HReal magnitude = ZERO;
+        for (auto coeff : coefficients)
+        {
+            magnitude = std::max(magnitude, std::abs(coeff));
+        }
+
+        if (magnitude > ZERO)
+        {
+            *this *= std::ldexp(ONE, -std::ilogb(magnitude));
+        }
     }
 
     TFunc1 Polynomial::AsFunction() const
@@ -202,6 +965,14 @@ namespace hmath
     }
 
     HReal Polynomial::evaluate(HReal value) const
+    {
+        if (getOrder() > ESTRIN_THRESHOLD)
+            return evaluateEstrin(value);
+
+        return evaluateHorner(value);
+    }
+
+    HReal Polynomial::evaluateHorner(HReal value) const
     {
         // Horner's method
         HReal y = ZERO;
@@ -214,43 +985,141 @@ namespace hmath
         return y;
     }
 
-    void Polynomial::shiftUp(unsigned int numShift)
+    HReal Polynomial::evaluateEstrin(HReal value) const
     {
-        if (numShift == 0)
-            return;
-            
-        std::vector<HReal> tmp;
-        tmp.reserve(coefficients.size() + numShift);
+        const size_t count = coefficients.size();
+        const HReal* coeffs = coefficients.data();
 
-        for (auto coeff : coefficients)
+        if (count <= ESTRIN_BLOCK_SIZE)
+            return evaluateEstrinBlock(coeffs, count, value);
+
+        // Blocks are combined by Horner's method in x^ESTRIN_BLOCK_SIZE.
+        HReal blockPower = value;
+        for (size_t size = 1; size < ESTRIN_BLOCK_SIZE; size *= 2)
         {
-            tmp.push_back(coeff);
+            blockPower = blockPower * blockPower;
         }
 
-        for (unsigned int i = 0; i < numShift; ++i)
+        size_t blockSize = count % ESTRIN_BLOCK_SIZE;
+        if (blockSize == 0)
         {
-            tmp.push_back(ZERO);
+            blockSize = ESTRIN_BLOCK_SIZE;
         }
 
-        std::swap(tmp, coefficients);
+        HReal y = evaluateEstrinBlock(coeffs, blockSize, value);
+
+        for (size_t index = blockSize; index < count; index += ESTRIN_BLOCK_SIZE)
+        {
+            y = y * blockPower + evaluateEstrinBlock(coeffs + index, ESTRIN_BLOCK_SIZE, value);
+        }
+
+        return y;
     }
-	
-    void Polynomial::shiftDown(unsigned int numShift)
+
+    void Polynomial::evaluate(std::span<const HReal> values, std::span<HReal> outResults) const
     {
-        if (numShift == 0)
+        if (outResults.size() < values.size())
+        {
+            using namespace std;
+            cerr << "[Polynomial][Error] " << __func__ << ": the output has " << outResults.size()
+                << " elements, but " << values.size() << " values are given." << endl;
+        }
+
+        const size_t count = std::min(values.size(), outResults.size());
+        const size_t numCoeffs = coefficients.size();
+        const HReal* coeffs = coefficients.data();
+        const HReal* xs = values.data();
+        HReal* ys = outResults.data();
+
+        if (numCoeffs == 0)
+        {
+            std::fill_n(ys, count, ZERO);
             return;
+        }
+
+        size_t index = 0;
+
+#if USE_SIMD && USE_HIGH_PRECISION && defined(__AVX512F__)
+        for (; index + 8 <= count; index += 8)
+        {
+            const __m512d x = _mm512_loadu_pd(xs + index);
+            __m512d y = _mm512_set1_pd(coeffs[0]);
+
+            for (size_t i = 1; i < numCoeffs; ++i)
+            {
+                y = _mm512_fmadd_pd(y, x, _mm512_set1_pd(coeffs[i]));
+            }
+
+            _mm512_storeu_pd(ys + index, y);
+        }
+#elif USE_SIMD && USE_HIGH_PRECISION && defined(__AVX2__)
+        for (; index + 4 <= count; index += 4)
+        {
+            const __m256d x = _mm256_loadu_pd(xs + index);
+            __m256d y = _mm256_set1_pd(coeffs[0]);
+
+            for (size_t i = 1; i < numCoeffs; ++i)
+            {
+#if defined(__FMA__)
+                y = _mm256_fmadd_pd(y, x, _mm256_set1_pd(coeffs[i]));
+#else // __FMA__
+                y = _mm256_add_pd(_mm256_mul_pd(y, x), _mm256_set1_pd(coeffs[i]));
+#endif // __FMA__
+            }
+
+            _mm256_storeu_pd(ys + index, y);
+        }
+#endif // USE_SIMD
 
-        std::vector<HReal> tmp;
+        // Portable path, Horner's method over a block of independent lanes
+        for (; index + EVALUATION_LANES <= count; index += EVALUATION_LANES)
+        {
+            HReal x[EVALUATION_LANES];
+            HReal y[EVALUATION_LANES];
+
+            for (size_t lane = 0; lane < EVALUATION_LANES; ++lane)
+            {
+                x[lane] = xs[index + lane];
+                y[lane] = coeffs[0];
+            }
 
-        auto newSize = coefficients.size() - numShift;
-        tmp.reserve(newSize);
+            for (size_t i = 1; i < numCoeffs; ++i)
+            {
+                const HReal coeff = coeffs[i];
+
+                for (size_t lane = 0; lane < EVALUATION_LANES; ++lane)
+                {
+                    y[lane] = y[lane] * x[lane] + coeff;
+                }
+            }
 
-        for (size_t i = 0; i < newSize; ++i)
+            for (size_t lane = 0; lane < EVALUATION_LANES; ++lane)
+            {
+                ys[index + lane] = y[lane];
+            }
+        }
+
+        for (; index < count; ++index)
         {
-            tmp.push_back(coefficients[i]);
+            ys[index] = evaluate(xs[index]);
         }
+    }
 
-        std::swap(tmp, coefficients);
+    void Polynomial::shiftUp(unsigned int numShift)
+    {
+        if (numShift == 0)
+            return;
+
+        coefficients.resize(coefficients.size() + numShift, ZERO);
+    }
+	
+    void Polynomial::shiftDown(unsigned int numShift)
+    {
+        if (numShift == 0)
+            return;
+
+        const size_t size = coefficients.size();
+        coefficients.resize(size > numShift ? size - numShift : 0);
     }
 
     void Polynomial::defferentiate()
@@ -278,6 +1147,30 @@ namespace hmath
         coefficients.push_back(constant);
     }
 
+    void Polynomial::setTaylorSeries(std::span<const HReal> taylorCoefficients, HReal point)
+    {
+        const size_t count = taylorCoefficients.size();
+
+        coefficients.clear();
+        coefficients.reserve(count);
+
+        for (size_t i = count; i-- > 0;)
+        {
+            coefficients.push_back(taylorCoefficients[i]);
+        }
+
+        // Taylor shift, q(x - point) expanded by repeated synthetic division
+        const HReal shift = -point;
+
+        for (size_t i = 0; i + 1 < count; ++i)
+        {
+            for (size_t j = 1; j < count - i; ++j)
+            {
+                coefficients[j] += shift * coefficients[j - 1];
+            }
+        }
+    }
+
     void Polynomial::print() const
     {
         using namespace std;
@@ -339,17 +1232,99 @@ namespace hmath
             Polynomial p({1, 2, -3, 1});
             p.print();
 
-            auto error = util::compare(p.AsFunction(), func, -10, 10, 0.01);
+            auto error = util::compare(p.AsFunction(), func, -10, 10, 0.01);
+            cout << "[Polynomial][TC" << inOutTestCount
+                << "] P value check: PASS, error = " << error << endl;
+
+            if (error > EPSILON)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] error " << error
+                    << " is bigger than expected " << SMALL_NUMBER << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Batch evaluation" << endl;
+        {
+            Polynomial p({ 0.5, -1, 2, 0, -3, 1, 0.25, 4 });
+
+            // Not a multiple of any lane width, so that the remainder path is also covered.
+            constexpr size_t count = 1003;
+            std::vector<HReal> xs(count);
+            std::vector<HReal> ys(count);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                xs[i] = -2 + i * (HReal(4) / count);
+            }
+
+            p.evaluate(xs, ys);
+
+            HReal error = ZERO;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto trueValue = p.evaluate(xs[i]);
+                error = std::max(error, analysis::getError(ys[i], trueValue));
+            }
+
+            cout << "[Polynomial][TC" << inOutTestCount
+                << "] Batch value check: error = " << error << endl;
+
+            if (error > EPSILON)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] error " << error
+                    << " is bigger than expected " << EPSILON << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Estrin's scheme" << endl;
+        {
+            HReal maxError = ZERO;
+
+            for (TOrder order = 0; order <= 600; order += (order < 64 ? 1 : 67))
+            {
+                std::vector<HReal> coeffs;
+                coeffs.reserve(order + 1);
+
+                for (TOrder i = 0; i <= order; ++i)
+                {
+                    coeffs.push_back(((i * 7) % 11 - 5) * ONE_TENTH);
+                }
+
+                Polynomial p(std::move(coeffs));
+
+                for (HReal x = -1; x <= 1; x += 0.125)
+                {
+                    auto error = analysis::getError(p.evaluateEstrin(x), p.evaluateHorner(x));
+                    maxError = std::max(maxError, error);
+                }
+            }
+
             cout << "[Polynomial][TC" << inOutTestCount
-                << "] P value check: PASS, error = " << error << endl;
+                << "] Estrin vs Horner: error = " << maxError << endl;
 
-            if (error > EPSILON)
+            if (maxError > EPSILON)
             {
                 ++errorCount;
 
                 ostringstream msg;
-                msg << "[Polynomial][TC" << inOutTestCount << "][Error] error " << error
-                    << " is bigger than expected " << SMALL_NUMBER << endl;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] error " << maxError
+                    << " is bigger than expected " << EPSILON << endl;
 
                 auto errorMsg = msg.view();
                 cerr << errorMsg;
@@ -358,6 +1333,49 @@ namespace hmath
             }
         }
 
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Benchmark: Horner vs Estrin latency" << endl;
+        {
+            using Clock = std::chrono::steady_clock;
+
+            constexpr int numIterations = 20000;
+
+            // Each input depends on the previous output, so that the timing measures latency.
+            auto measure = [](auto&& evaluateFunc) -> double
+            {
+                HReal x = HALF;
+                HReal sum = ZERO;
+
+                const auto startTime = Clock::now();
+
+                for (int i = 0; i < numIterations; ++i)
+                {
+                    const HReal y = evaluateFunc(x);
+                    sum += y;
+                    x = HALF + y * NANO;
+                }
+
+                const auto endTime = Clock::now();
+                const std::chrono::duration<double, std::nano> elapsed = endTime - startTime;
+
+                volatile HReal sink = sum;
+                (void)sink;
+
+                return elapsed.count() / numIterations;
+            };
+
+            // Finer steps around ESTRIN_THRESHOLD, where the two cross.
+            for (TOrder order : { 4, 8, 12, 16, 24, 32, 64, 128, 256 })
+            {
+                Polynomial p(std::vector<HReal>(order + 1, ONE_TENTH));
+
+                const auto hornerTime = measure([&p](HReal x) { return p.evaluateHorner(x); });
+                const auto estrinTime = measure([&p](HReal x) { return p.evaluateEstrin(x); });
+
+                cout << "[Polynomial][TC" << inOutTestCount << "] order " << order
+                    << ": Horner " << hornerTime << " ns, Estrin " << estrinTime << " ns" << endl;
+            }
+        }
+
         cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Add two polynomials" << endl;
         {
             auto func = [](HReal x) { return x * x * x + 2 * x * x + x + 2; };
@@ -487,6 +1505,310 @@ namespace hmath
             }
         }
 
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Karatsuba and FFT multiplication" << endl;
+        {
+            auto makePolynomial = [](TOrder numCoeffs, int seed)
+            {
+                std::vector<HReal> coeffs;
+                coeffs.reserve(numCoeffs);
+
+                for (TOrder i = 0; i < numCoeffs; ++i)
+                {
+                    coeffs.push_back(((i * seed + 3) % 17 - 8) * ONE_TENTH);
+                }
+
+                return Polynomial(std::move(coeffs));
+            };
+
+            const std::pair<TOrder, TOrder> sizes[] = { {1, 40}, {33, 70}, {100, 100}, {257, 3000}, {1500, 1800} };
+
+            for (auto [sizeA, sizeB] : sizes)
+            {
+                const auto p1 = makePolynomial(sizeA, 5);
+                const auto p2 = makePolynomial(sizeB, 7);
+
+                const auto direct = p1.multiply(p2, MultiplicationMethod::Direct);
+
+                const std::pair<const char*, MultiplicationMethod> methods[] = {
+                    { "Karatsuba", MultiplicationMethod::Karatsuba },
+                    { "FFT", MultiplicationMethod::FFT },
+                    { "Auto", MultiplicationMethod::Auto } };
+
+                for (auto [name, method] : methods)
+                {
+                    const auto product = p1.multiply(p2, method);
+
+                    HReal error = product.numCoefficients() == direct.numCoefficients() ? ZERO : MAX_NUMBER;
+                    for (TOrder i = 0; i < direct.numCoefficients(); ++i)
+                    {
+                        error = std::max(error, analysis::getError(product.getCoefficient(i), direct.getCoefficient(i)));
+                    }
+
+                    cout << "[Polynomial][TC" << inOutTestCount << "] " << sizeA << " x " << sizeB
+                        << " coefficients, " << name << ": error = " << error << endl;
+
+                    if (error > EPSILON)
+                    {
+                        ++errorCount;
+
+                        ostringstream msg;
+                        msg << "[Polynomial][TC" << inOutTestCount << "][Error] " << name << " error " << error
+                            << " is bigger than expected " << EPSILON << endl;
+
+                        auto errorMsg = msg.view();
+                        cerr << errorMsg;
+
+                        outErrorMessages.emplace_back(errorMsg);
+                    }
+                }
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") In-place arithmetic" << endl;
+        {
+            const Polynomial p1({ 1, 2, 3 });
+            const Polynomial p2({ 4, 5, 6, 7, 8 });
+            const Polynomial p3({ 1, -1 });
+
+            Polynomial sum = p1;
+            sum += p2;
+            sum -= p3;
+            sum *= p3;
+            sum *= TWO;
+
+            const Polynomial answer = (p1 + p2 - p3) * p3 * TWO;
+            const Polynomial movedAnswer = (Polynomial(p1) + Polynomial(p2) - Polynomial(p3)) * p3 * TWO;
+            const Polynomial movedRhsAnswer = (p1 - (Polynomial(p3) - Polynomial(p2))) * p3 * TWO;
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] (" << p1 << ") + (" << p2 << ") - (" << p3
+                << ") X (" << p3 << ") X 2 = (" << sum << ')' << endl;
+
+            if (sum != answer || movedAnswer != answer || movedRhsAnswer != answer)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] error " << sum
+                    << " doesn't coincide with " << answer << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Allocation-free steady state" << endl;
+        {
+            const std::vector<Polynomial> terms = {
+                Polynomial({ 1, 2, 3 }),
+                Polynomial({ -1, 0.5, 2, 1 }),
+                Polynomial({ 3, 1 }),
+                Polynomial({ 2, 0, 0, 1, -2 }) };
+
+            const Polynomial factor({ 1, -1 });
+
+            Polynomial sum;
+            Polynomial total;
+
+            auto accumulate = [&]()
+            {
+                sum = terms[0];
+
+                for (int repeat = 0; repeat < 10; ++repeat)
+                {
+                    for (const auto& term : terms)
+                    {
+                        sum += term;
+                        sum *= HALF;
+                        sum -= term;
+                    }
+                }
+
+                sum *= factor;
+                sum *= HALF;
+
+                total = std::move(sum) + terms[1] - terms[2] + terms[3];
+                sum = std::move(total);
+            };
+
+            // The first pass reserves the storage, the following passes should reuse it.
+            accumulate();
+
+            const auto result = sum;
+            const auto startCount = GetAllocationCount();
+
+            for (int i = 0; i < 100; ++i)
+            {
+                accumulate();
+            }
+
+            const auto numAllocations = GetAllocationCount() - startCount;
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] allocations in the steady state = "
+                << numAllocations << endl;
+
+            if (numAllocations != 0 || sum != result)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] " << numAllocations
+                    << " allocations found in the steady state, or (" << sum
+                    << ") doesn't coincide with (" << result << ')' << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Inline coefficient storage" << endl;
+        {
+            const Polynomial p1({ 1, -2, 3, 0.5 });
+            const Polynomial p2({ 2, 0, -1, 4 });
+
+            const auto startCount = GetAllocationCount();
+
+            Polynomial copied = p1;
+            Polynomial sum = p1 + p2;
+            Polynomial product = p1 * p2;
+            Polynomial moved = std::move(sum);
+
+            const auto numAllocations = GetAllocationCount() - startCount;
+
+            // Spilled to the heap beyond the inline capacity, and copied back.
+            Polynomial large = product;
+            large.shiftUp(INLINE_CAPACITY);
+            Polynomial largeCopy = large;
+            largeCopy.shiftDown(INLINE_CAPACITY);
+
+            const Polynomial productAnswer({ 2, -4, 5, 7, -11, 11.5, 2 });
+
+            // A FunctionRef refers to the polynomial as it is, and a TFunc1 allocates its own storage only.
+            auto functionCount = GetAllocationCount();
+            const FunctionRef ref = product;
+            const HReal refValue = ref(HALF);
+            const auto numRefAllocations = GetAllocationCount() - functionCount;
+
+            functionCount = GetAllocationCount();
+            const TFunc1 func = product.AsFunction();
+            const HReal funcValue = func(HALF);
+            const auto numFuncAllocations = GetAllocationCount() - functionCount;
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] allocations for polynomials of order "
+                << p1.getOrder() << " = " << numAllocations << ", FunctionRef = " << numRefAllocations
+                << ", AsFunction = " << numFuncAllocations << endl;
+
+            if (numAllocations != 0 || copied != p1 || moved != p1 + p2
+                || product != productAnswer || largeCopy != productAnswer
+                || numRefAllocations != 0 || numFuncAllocations > 1
+                || refValue != product.evaluate(HALF) || funcValue != refValue)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] " << numAllocations
+                    << " allocations found, " << numRefAllocations << " for FunctionRef, "
+                    << numFuncAllocations << " for AsFunction, or (" << largeCopy << ") doesn't coincide with ("
+                    << productAnswer << ')' << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Static polynomial" << endl;
+        {
+            constexpr StaticPolynomial<3> p1(1, 2, -3, 1);
+            constexpr StaticPolynomial<1> p2(1, 1);
+
+            constexpr auto sum = p1 + p2;
+            constexpr auto difference = p2 - p1;
+            constexpr auto product = p1 * p2;
+            constexpr auto dp = p1.derivative();
+            constexpr auto integral = dp.integral(ONE);
+
+            // Folded at compile time
+            static_assert(p1.evaluate(2) == 11);
+            static_assert(sum == StaticPolynomial<3>(1, 2, -2, 2));
+            static_assert(difference == StaticPolynomial<3>(-1, -2, 4, 0));
+            static_assert(product == StaticPolynomial<4>(1, 3, -1, -2, 1));
+            static_assert(dp == StaticPolynomial<2>(3, 4, -3));
+            static_assert(integral == p1);
+            static_assert(StaticPolynomial<0>(5).derivative().getOrder() == 0);
+
+            const Polynomial dynamicProduct = Polynomial({ 1, 2, -3, 1 }) * Polynomial({ 1, 1 });
+            auto error = util::compare(product, dynamicProduct.AsFunction(), -10, 10, 0.01);
+
+            cout << "[Polynomial][TC" << inOutTestCount
+                << "] Static vs dynamic polynomial: error = " << error << endl;
+
+            if (error > EPSILON)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] error " << error
+                    << " is bigger than expected " << EPSILON << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Taylor series" << endl;
+        {
+            constexpr HReal point = 1;
+            constexpr int depth = 12;
+
+            auto func = [](auto x) { return sin(x) * exp(x * HALF); };
+            auto trueFunc = [](HReal x) -> HReal { return std::sin(x) * std::exp(x * HALF); };
+
+            Polynomial exact(autodiff::TAYLOR_SERIES, func, point, depth);
+
+            // Without the tag, generic callables take the finite differences, as they did before the tag existed.
+            Polynomial approximate([](auto x) { return std::sin(x) * std::exp(x * HALF); }, point, 5);
+
+            const auto exactError = util::compare(exact.AsFunction(), trueFunc, point - HALF, point + HALF, 0.01);
+            const auto approximateError = util::compare(approximate.AsFunction(), trueFunc,
+                point - ONE_TENTH, point + ONE_TENTH, 0.001);
+
+            // Powers of x at the origin, where the power series of x^a can't divide by x.
+            Polynomial atOrigin(autodiff::TAYLOR_SERIES, [](auto x) { return pow(x, 3.0) + x; }, 0, depth);
+            const auto originError = util::compare(atOrigin.AsFunction(), [](HReal x) -> HReal { return x * x * x + x; },
+                -HALF, HALF, 0.01);
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] Taylor series by automatic differentiation ("
+                << exact << "): error = " << exactError << endl;
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] Taylor series at the origin ("
+                << atOrigin << "): error = " << originError << endl;
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] Taylor series by finite differences ("
+                << approximate << "): error = " << approximateError << endl;
+
+            if (exactError > EPSILON || approximateError > SMALL_NUMBER || !(originError <= EPSILON))
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] error " << exactError
+                    << ", " << approximateError << ", " << originError << " is bigger than expected " << EPSILON
+                    << ", " << SMALL_NUMBER << ", " << EPSILON << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
         cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Differentiation" << endl;
         {
 
@@ -541,6 +1863,235 @@ namespace hmath
             }
         }
 
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Division" << endl;
+        {
+            const Polynomial divisor({ 2, 0, 1 });
+            const Polynomial trueQuotient({ 1, -3, 0.5 });
+            const Polynomial trueRemainder({ 2, -1 });
+            const Polynomial dividend = divisor * trueQuotient + trueRemainder;
+
+            Polynomial quotient;
+            Polynomial remainder;
+            dividend.divide(divisor, quotient, remainder);
+
+            Polynomial exactRemainder;
+            (divisor * trueQuotient).remainder(divisor, exactRemainder);
+
+            // Leading zeros of the divisor don't change the result.
+            Polynomial paddedQuotient;
+            Polynomial paddedRemainder;
+            dividend.divide(Polynomial({ 0, 0, 2, 0, 1 }), paddedQuotient, paddedRemainder);
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] (" << dividend << ") / (" << divisor << ") = ("
+                << quotient << "), remainder (" << remainder << ')' << endl;
+
+            const bool bExact = quotient == trueQuotient && remainder == trueRemainder;
+
+            // Repeated divisions of a polynomial beyond the inline capacity reuse the outputs.
+            const Polynomial large({ 1, -2, 3, -4, 5, -6, 7, -8, 9, -10, 11, -12 });
+            large.divide(divisor, quotient, remainder);
+
+            const auto startCount = GetAllocationCount();
+            for (int i = 0; i < 100; ++i)
+            {
+                large.divide(divisor, quotient, remainder);
+            }
+
+            const auto numAllocations = GetAllocationCount() - startCount;
+            const Polynomial restored = quotient * divisor + remainder;
+
+            if (!bExact || paddedQuotient != trueQuotient || paddedRemainder != trueRemainder
+                || exactRemainder.numCoefficients() != 0 || numAllocations != 0 || restored != large
+                || remainder.getOrder() >= divisor.getOrder())
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] division failed, quotient (" << paddedQuotient
+                    << "), remainder (" << paddedRemainder << "), allocations = " << numAllocations << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Synthetic division" << endl;
+        {
+            // (x - 2)(x + 1)(x - 0.5)(x^2 + 3)
+            const Polynomial p1 = Polynomial({ 1, -2 }) * Polynomial({ 1, 1 }) * Polynomial({ 1, -0.5 })
+                * Polynomial({ 1, 0, 3 });
+
+            Polynomial deflated = p1;
+            const HReal remainders[] = { deflated.deflate(2), deflated.deflate(-1), deflated.deflate(0.5) };
+
+            Polynomial shifted = p1;
+            const HReal value = shifted.deflate(3);
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] (" << p1 << ") deflated by 2, -1 and 0.5 = ("
+                << deflated << ')' << endl;
+
+            // Deflation loops on polynomials beyond the inline capacity reuse the storage.
+            const Polynomial large({ 1, -2, 3, -4, 5, -6, 7, -8, 9, -10, 11, -12 });
+            Polynomial work = large;
+
+            const auto startCount = GetAllocationCount();
+            for (int i = 0; i < 100; ++i)
+            {
+                work = large;
+                while (work.numCoefficients() > 1)
+                {
+                    work.deflate(0.5);
+                }
+            }
+
+            const auto numAllocations = GetAllocationCount() - startCount;
+
+            if (deflated != Polynomial({ 1, 0, 3 }) || remainders[0] != 0 || remainders[1] != 0 || remainders[2] != 0
+                || value != p1.evaluate(3) || numAllocations != 0)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] deflation failed, (" << deflated
+                    << "), p(3) = " << value << ", allocations = " << numAllocations << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Polynomial GCD" << endl;
+        {
+            // (x - 1)(x + 2)^2(x^2 + 1) and 3(x + 2)(x - 3)(x - 1), of which the GCD is x^2 + x - 2.
+            const Polynomial p1 = Polynomial({ 1, -1 }) * Polynomial({ 1, 2 }) * Polynomial({ 1, 2 })
+                * Polynomial({ 1, 0, 1 });
+            const Polynomial p2 = Polynomial({ 3, 6 }) * Polynomial({ 1, -3 }) * Polynomial({ 1, -1 });
+            const Polynomial answer({ 1, 1, -2 });
+
+            Polynomial::Workspace workspace;
+            Polynomial divisor;
+            Polynomial coprime;
+
+            Polynomial::gcd(p1, p2, divisor, workspace);
+            Polynomial::gcd(p1, Polynomial({ 1, -5 }), coprime, workspace);
+
+            HReal error = divisor.numCoefficients() == answer.numCoefficients() ? ZERO : ONE;
+            for (int i = 0; i < std::min(divisor.numCoefficients(), answer.numCoefficients()); ++i)
+            {
+                error = std::max(error, std::abs(divisor.getCoefficient(i) - answer.getCoefficient(i)));
+            }
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] gcd(" << p1 << ", " << p2 << ") = (" << divisor << ')'
+                << endl;
+
+            // The same orders again, beyond the inline capacity, reuse the workspace.
+            const Polynomial p3 = p1 * Polynomial({ 1, 0, 0, 0, 2 });
+            const Polynomial p4 = p2 * Polynomial({ 1, 0, 0, 0, 0, 0, -1 });
+            Polynomial::gcd(p3, p4, divisor, workspace);
+
+            const auto startCount = GetAllocationCount();
+            for (int i = 0; i < 100; ++i)
+            {
+                Polynomial::gcd(p3, p4, divisor, workspace);
+            }
+
+            const auto numAllocations = GetAllocationCount() - startCount;
+
+            if (error > 1e-12 || coprime != Polynomial({ 1 }) || numAllocations != 0)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] gcd (" << divisor << ") or (" << coprime
+                    << ") is wrong, error = " << error << ", allocations = " << numAllocations << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
+        cout << endl << "[Polynomial] TestCase " << ++inOutTestCount << ") Newton division" << endl;
+        {
+            constexpr int divisorSize = 1500;
+
+            // The leading coefficient dominates, so every root of the divisor is inside the unit circle,
+            // and the reciprocal series of its reversal converges.
+            std::vector<HReal> dividendCoeffs(2 * divisorSize + 7);
+            std::vector<HReal> divisorCoeffs(divisorSize);
+
+            for (size_t i = 0; i < dividendCoeffs.size(); ++i)
+            {
+                dividendCoeffs[i] = std::sin(1.3 * i);
+            }
+
+            divisorCoeffs[0] = ONE;
+            for (int i = 1; i < divisorSize; ++i)
+            {
+                divisorCoeffs[i] = HALF * std::cos(0.7 * i) / divisorSize;
+            }
+
+            const Polynomial dividend(dividendCoeffs);
+            const Polynomial divisor(divisorCoeffs);
+
+            Polynomial::Workspace workspace;
+            Polynomial longQuotient;
+            Polynomial longRemainder;
+            Polynomial newtonQuotient;
+            Polynomial newtonRemainder;
+
+            using Clock = std::chrono::steady_clock;
+
+            const auto longStart = Clock::now();
+            dividend.divide(divisor, longQuotient, longRemainder, workspace, DivisionMethod::Long);
+            const auto newtonStart = Clock::now();
+            dividend.divide(divisor, newtonQuotient, newtonRemainder, workspace, DivisionMethod::Newton);
+            const auto newtonEnd = Clock::now();
+
+            const chrono::duration<double, milli> longTime = newtonStart - longStart;
+            const chrono::duration<double, milli> newtonTime = newtonEnd - newtonStart;
+
+            // The workspace and the outputs have the capacity of the first division by now.
+            const auto allocationCount = GetAllocationCount();
+            dividend.divide(divisor, newtonQuotient, newtonRemainder, workspace, DivisionMethod::Newton);
+            const auto numAllocations = GetAllocationCount() - allocationCount;
+
+            HReal error = ZERO;
+            for (int i = 0; i < longQuotient.numCoefficients(); ++i)
+            {
+                error = std::max(error, std::abs(longQuotient.getCoefficient(i) - newtonQuotient.getCoefficient(i)));
+            }
+
+            for (int i = 0; i < longRemainder.numCoefficients(); ++i)
+            {
+                error = std::max(error, std::abs(longRemainder.getCoefficient(i) - newtonRemainder.getCoefficient(i)));
+            }
+
+            cout << "[Polynomial][TC" << inOutTestCount << "] long = " << longTime.count() << " ms, Newton = "
+                << newtonTime.count() << " ms, error = " << error << ", allocations = " << numAllocations << endl;
+
+            if (newtonQuotient.numCoefficients() != longQuotient.numCoefficients()
+                || newtonRemainder.numCoefficients() != longRemainder.numCoefficients() || error > 1e-10
+                || numAllocations != 0)
+            {
+                ++errorCount;
+
+                ostringstream msg;
+                msg << "[Polynomial][TC" << inOutTestCount << "][Error] Newton division differs from long division, error = "
+                    << error << ", allocations = " << numAllocations << endl;
+
+                auto errorMsg = msg.view();
+                cerr << errorMsg;
+
+                outErrorMessages.emplace_back(errorMsg);
+            }
+        }
+
         return errorCount;
     }
 #endif // DO_TEST
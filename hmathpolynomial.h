@@ -1,12 +1,16 @@
 #pragma once
 
+#include "hmathautodiff.h"
 #include "hmathconfig.h"
 #include "hmathconstants.h"
+#include "hmathinlinebuffer.h"
 #include "hmathtypes.h"
 
+#include <complex>
 #include <initializer_list>
-#include <vector>
 #include <ostream>
+#include <span>
+#include <vector>
 
 
 namespace hmath
@@ -15,22 +19,94 @@ namespace hmath
 	{
 		using TOrder = int;
 
+	public:
+		// Orders above this evaluate with Estrin's scheme rather than Horner's method.
+		// By the latency benchmark of the tests, Horner's method is faster up to order 12 and Estrin's scheme from order 16.
+		static constexpr TOrder ESTRIN_THRESHOLD = 15;
+
+		// Multiplication switches from the direct convolution to Karatsuba's method
+		// at KARATSUBA_THRESHOLD coefficients, and to the FFT at FFT_THRESHOLD coefficients of the product.
+		static constexpr TOrder KARATSUBA_THRESHOLD = 32;
+		static constexpr TOrder FFT_THRESHOLD = 2048;
+
+		enum class MultiplicationMethod
+		{
+			Auto,
+			Direct,
+			Karatsuba,
+			FFT
+		};
+
+		// Division switches from long division to Newton's iteration on the reciprocal of the divisor
+		// once both the quotient and the divisor have NEWTON_DIVISION_THRESHOLD coefficients.
+		// Long division vectorizes well, so Newton's division only wins once its multiplications run on the FFT.
+		static constexpr TOrder NEWTON_DIVISION_THRESHOLD = 8192;
+
+		enum class DivisionMethod
+		{
+			Auto,
+			Long,
+			Newton
+		};
+
+		// Remainder coefficients of the Euclidean algorithm below this,
+		// relative to the largest coefficient of the dividend, are taken as rounding noise.
+		static constexpr HReal GCD_TOLERANCE = MACHINE_EPSILON * 1024;
+
+		// Scratch polynomials of division and GCD, of which the storage is reused between calls.
+		struct Workspace;
+
+		// Coefficients up to this number are stored inside the object, without heap allocation.
+		static constexpr TOrder INLINE_CAPACITY = POLYNOMIAL_INLINE_CAPACITY;
+
 	private:
-		std::vector<HReal> coefficients;
+		using TCoefficients = InlineBuffer<HReal, INLINE_CAPACITY>;
+
+		TCoefficients coefficients;
 
 	public:
 		Polynomial() = default;
 		Polynomial(std::initializer_list<HReal> inCoefficients);
 		explicit Polynomial(const std::vector<HReal>& inCoefficients);
-		explicit Polynomial(std::vector<HReal>&& inCoefficients);
+
+		// Taylor series of the given function at the point, with depth coefficients.
+		// The derivatives are estimated by finite differences of the step epsilon, widened for higher orders.
 		explicit Polynomial(TFunc1 smoothFunc, HReal point, int depth = 5, HReal epsilon = EPSILON);
+
+		// Taylor series of a generic function at the point, with depth coefficients.
+		// The function is evaluated once on autodiff::TaylorNumber, so the coefficients are exact up to rounding.
+		template <typename TFunc>
+		Polynomial(autodiff::TaylorSeriesTag, TFunc&& smoothFunc, HReal point, int depth = 5)
+		{
+			const autodiff::TaylorNumber series = smoothFunc(autodiff::TaylorNumber::variable(point, depth));
+			setTaylorSeries(series.getCoefficients(), point);
+		}
+
+		Polynomial(const Polynomial&) = default;
+		Polynomial(Polynomial&&) noexcept = default;
 		~Polynomial() = default;
 
-		Polynomial operator+ (const Polynomial& rhs) const;
-		Polynomial operator- (const Polynomial& rhs) const;
+		Polynomial& operator= (const Polynomial&) = default;
+		Polynomial& operator= (Polynomial&&) noexcept = default;
+
+		// Overloads taking temporaries reuse their storage instead of allocating a new one.
+		Polynomial operator+ (const Polynomial& rhs) const&;
+		Polynomial operator+ (const Polynomial& rhs) &&;
+		Polynomial operator+ (Polynomial&& rhs) const&;
+		Polynomial operator+ (Polynomial&& rhs) &&;
+		Polynomial operator- (const Polynomial& rhs) const&;
+		Polynomial operator- (const Polynomial& rhs) &&;
+		Polynomial operator- (Polynomial&& rhs) const&;
+		Polynomial operator- (Polynomial&& rhs) &&;
 		Polynomial operator* (const Polynomial& rhs) const;
-		Polynomial operator* (HReal value) const;
-		void operator*= (HReal value);	
+		Polynomial operator* (HReal value) const&;
+		Polynomial operator* (HReal value) &&;
+
+		// Compound assignments don't allocate as long as the capacity suffices.
+		Polynomial& operator+= (const Polynomial& rhs);
+		Polynomial& operator-= (const Polynomial& rhs);
+		Polynomial& operator*= (const Polynomial& rhs);
+		Polynomial& operator*= (HReal value);
 
 		inline bool operator== (const Polynomial& rhs) const { return coefficients == rhs.coefficients; }
 		inline bool operator!= (const Polynomial& rhs) const { return coefficients != rhs.coefficients; }
@@ -38,12 +114,56 @@ namespace hmath
 		friend std::ostream& operator<< (std::ostream& stream, const Polynomial& polynomial);
 
 	public:
+		// A polynomial is itself a callable, which binds to a FunctionRef without a copy.
+		// AsFunction() copies it into a TFunc1, of which storage std::function allocates,
+		// since a polynomial is larger than the inline storage of the standard libraries.
+		HReal operator() (HReal value) const { return evaluate(value); }
 		TFunc1 AsFunction() const;
 
 		TOrder numCoefficients() const;
 		TOrder getOrder() const;
 		HReal getCoefficient(TOrder index) const;
+		Polynomial multiply(const Polynomial& rhs, MultiplicationMethod method = MultiplicationMethod::Auto) const;
+
+		// Product into outProduct, where the temporaries of Karatsuba's method and the FFT stay in the workspace,
+		// so that it doesn't allocate once their capacity suffices.
+		void multiply(const Polynomial& rhs, Polynomial& outProduct, Workspace& workspace,
+			MultiplicationMethod method = MultiplicationMethod::Auto) const;
+
+		// Division, this = quotient * divisor + remainder, where the order of the remainder is below the divisor's.
+		// The outputs and the workspace reuse their storage, so that divisions by either method don't allocate
+		// once their capacity suffices.
+		// Leading zeros of the divisor are ignored, and those of the remainder are removed.
+		void divide(const Polynomial& divisor, Polynomial& outQuotient, Polynomial& outRemainder) const;
+		void divide(const Polynomial& divisor, Polynomial& outQuotient, Polynomial& outRemainder,
+			Workspace& workspace, DivisionMethod method = DivisionMethod::Auto) const;
+		void remainder(const Polynomial& divisor, Polynomial& outRemainder) const;
+		void remainder(const Polynomial& divisor, Polynomial& outRemainder,
+			Workspace& workspace, DivisionMethod method = DivisionMethod::Auto) const;
+
+		// Synthetic division by (x - root) in place, for deflation after finding a root.
+		// Returns the remainder, which is the value at the root.
+		HReal deflate(HReal root);
+
+		// Monic greatest common divisor by the Euclidean algorithm, where remainders are trimmed by the tolerance.
+		// It is empty if both are zero.
+		static void gcd(const Polynomial& lhs, const Polynomial& rhs, Polynomial& outGcd,
+			Workspace& workspace, HReal tolerance = GCD_TOLERANCE);
+
+		// Removes the leading coefficients of which the magnitude doesn't exceed the tolerance.
+		void trim(HReal tolerance = ZERO);
+
+		// Scales the largest coefficient into [1, 2) by a power of two, which is exact,
+		// so that the signs and the zeros of the values are kept.
+		void normalize();
+
 		HReal evaluate(HReal value) const;
+		HReal evaluateHorner(HReal value) const;
+		HReal evaluateEstrin(HReal value) const;
+
+		// Evaluates every value of the input at once, Horner's method runs across SIMD lanes.
+		// outResults should have at least as many elements as values.
+		void evaluate(std::span<const HReal> values, std::span<HReal> outResults) const;
 
 		void shiftUp(unsigned int numShift);
 		void shiftDown(unsigned int numShift);
@@ -53,9 +173,35 @@ namespace hmath
 		void print() const;
 		void print(HReal value) const;
 
+	private:
+		void divide(const Polynomial& divisor, Polynomial* outQuotient, Polynomial& outRemainder,
+			Workspace& workspace, DivisionMethod method) const;
+		void divideNewton(const HReal* divisor, size_t divisorSize, Polynomial* outQuotient, Polynomial& outRemainder,
+			Workspace& workspace) const;
+
+		// Sets the polynomial in x from the coefficients of powers of (x - point), in ascending order.
+		void setTaylorSeries(std::span<const HReal> taylorCoefficients, HReal point);
+
+	public:
 #if DO_TEST
 		static int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
 #endif // DO_TEST
 	};
+
+	struct Polynomial::Workspace final
+	{
+		Polynomial quotient;
+		Polynomial inverse;
+		Polynomial truncated;
+		Polynomial product;
+		Polynomial lhs;
+		Polynomial rhs;
+
+		// Temporaries of the multiplication
+		std::vector<HReal> scratch;
+		std::vector<std::complex<HReal>> fftLhs;
+		std::vector<std::complex<HReal>> fftRhs;
+		std::vector<std::complex<HReal>> twiddles;
+	};
 }
 
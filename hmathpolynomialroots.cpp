@@ -0,0 +1,1055 @@
+#include "hmathpolynomialroots.h"
+
+#include "hmath.h"
+#include "hmathanalysis.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+
+
+namespace hmath
+{
+namespace roots
+{
+
+namespace
+{
+	// p, p' and sum |a_i| |z|^i of LANE_WIDTH points, in separate real and imaginary parts.
+	struct Evaluation final
+	{
+		HReal valueRe[LANE_WIDTH];
+		HReal valueIm[LANE_WIDTH];
+		HReal derivativeRe[LANE_WIDTH];
+		HReal derivativeIm[LANE_WIDTH];
+		HReal bound[LANE_WIDTH];
+	};
+
+	// Horner's method on complex points with real coefficients in descending order.
+	// Shared coefficients apply to every lane, otherwise coeffs[i * LANE_WIDTH + lane] is the coefficient i of the lane.
+	template <bool bSharedCoefficients>
+	void evaluateLanes(Evaluation& out, const HReal* coeffs, size_t numCoeffs, const HReal* re, const HReal* im)
+	{
+		auto getCoeff = [coeffs](size_t i, size_t lane) -> HReal
+		{
+			return bSharedCoefficients ? coeffs[i] : coeffs[i * LANE_WIDTH + lane];
+		};
+
+		HReal norm[LANE_WIDTH];
+
+		for (size_t lane = 0; lane < LANE_WIDTH; ++lane)
+		{
+			out.valueRe[lane] = getCoeff(0, lane);
+			out.valueIm[lane] = ZERO;
+			out.derivativeRe[lane] = ZERO;
+			out.derivativeIm[lane] = ZERO;
+			out.bound[lane] = std::abs(getCoeff(0, lane));
+			norm[lane] = std::sqrt(re[lane] * re[lane] + im[lane] * im[lane]);
+		}
+
+		for (size_t i = 1; i < numCoeffs; ++i)
+		{
+			for (size_t lane = 0; lane < LANE_WIDTH; ++lane)
+			{
+				const HReal x = re[lane];
+				const HReal y = im[lane];
+				const HReal pRe = out.valueRe[lane];
+				const HReal pIm = out.valueIm[lane];
+				const HReal dRe = out.derivativeRe[lane];
+				const HReal dIm = out.derivativeIm[lane];
+				const HReal coeff = getCoeff(i, lane);
+
+				// p' = p' * z + p, then p = p * z + a_i
+				out.derivativeRe[lane] = dRe * x - dIm * y + pRe;
+				out.derivativeIm[lane] = dRe * y + dIm * x + pIm;
+				out.valueRe[lane] = pRe * x - pIm * y + coeff;
+				out.valueIm[lane] = pRe * y + pIm * x;
+				out.bound[lane] = out.bound[lane] * norm[lane] + std::abs(coeff);
+			}
+		}
+	}
+
+	// Coefficients divided by the leading one, of which the order is the number of roots.
+	bool getMonicCoefficients(std::vector<HReal>& outCoeffs, const Polynomial& polynomial, const char* caller)
+	{
+		const HReal leading = polynomial.getCoefficient(0);
+
+		if (leading == ZERO && polynomial.numCoefficients() > 0)
+		{
+			using namespace std;
+			cerr << "[hmath][roots][Error] " << caller << ": the leading coefficient is zero." << endl;
+
+			return false;
+		}
+
+		const size_t numCoeffs = static_cast<size_t>(std::max(0, polynomial.numCoefficients()));
+		outCoeffs.resize(numCoeffs);
+
+		for (size_t i = 0; i < numCoeffs; ++i)
+		{
+			outCoeffs[i] = polynomial.getCoefficient(static_cast<int>(i)) / leading;
+		}
+
+		return true;
+	}
+
+	// Estimates on a circle of which the radius, max |a_i|^(1 / i), is at least half of the largest root modulus.
+	// The angles are offset from the real axis, so that estimates of a real polynomial aren't conjugates of each other.
+	void getInitialEstimates(const HReal* monicCoeffs, size_t order, HReal* outRe, HReal* outIm, size_t stride)
+	{
+		HReal radius = ZERO;
+
+		for (size_t i = 1; i <= order; ++i)
+		{
+			radius = std::max(radius, std::pow(std::abs(monicCoeffs[i]), ONE / static_cast<HReal>(i)));
+		}
+
+		if (radius == ZERO)
+		{
+			radius = ONE;
+		}
+
+		constexpr HReal angleOffset = 0.4;
+
+		for (size_t k = 0; k < order; ++k)
+		{
+			const HReal angle = TWO_PI * static_cast<HReal>(k) / static_cast<HReal>(order) + angleOffset;
+			outRe[k * stride] = radius * std::cos(angle);
+			outIm[k * stride] = radius * std::sin(angle);
+		}
+	}
+} // anonymous
+
+void evaluate(const Polynomial& polynomial, std::span<const TComplex> values,
+	std::span<TComplex> outValues, std::span<TComplex> outDerivatives)
+{
+	if (outValues.size() < values.size() || outDerivatives.size() < values.size())
+	{
+		using namespace std;
+		cerr << "[hmath][roots][Error] " << __func__ << ": the outputs have " << outValues.size()
+			<< " and " << outDerivatives.size() << " elements, but " << values.size() << " values are given." << endl;
+	}
+
+	const size_t count = std::min({ values.size(), outValues.size(), outDerivatives.size() });
+	const size_t numCoeffs = static_cast<size_t>(std::max(0, polynomial.numCoefficients()));
+
+	std::vector<HReal> coeffs(numCoeffs);
+	for (size_t i = 0; i < numCoeffs; ++i)
+	{
+		coeffs[i] = polynomial.getCoefficient(static_cast<int>(i));
+	}
+
+	if (numCoeffs == 0)
+	{
+		std::fill_n(outValues.begin(), count, TComplex());
+		std::fill_n(outDerivatives.begin(), count, TComplex());
+		return;
+	}
+
+	Evaluation evaluation;
+
+	for (size_t block = 0; block < count; block += LANE_WIDTH)
+	{
+		const size_t width = std::min(LANE_WIDTH, count - block);
+
+		HReal re[LANE_WIDTH] = {};
+		HReal im[LANE_WIDTH] = {};
+
+		for (size_t lane = 0; lane < width; ++lane)
+		{
+			re[lane] = values[block + lane].real();
+			im[lane] = values[block + lane].imag();
+		}
+
+		evaluateLanes<true>(evaluation, coeffs.data(), numCoeffs, re, im);
+
+		for (size_t lane = 0; lane < width; ++lane)
+		{
+			outValues[block + lane] = TComplex(evaluation.valueRe[lane], evaluation.valueIm[lane]);
+			outDerivatives[block + lane] = TComplex(evaluation.derivativeRe[lane], evaluation.derivativeIm[lane]);
+		}
+	}
+}
+
+bool aberthMethod(int& outIterationCount, std::span<TComplex> outRoots, const Polynomial& polynomial,
+	int maxCount, HReal epsilon)
+{
+	outIterationCount = 0;
+
+	std::vector<HReal> coeffs;
+	if (!getMonicCoefficients(coeffs, polynomial, __func__))
+		return false;
+
+	const size_t order = coeffs.empty() ? 0 : coeffs.size() - 1;
+
+	if (outRoots.size() < order)
+	{
+		using namespace std;
+		cerr << "[hmath][roots][Error] " << __func__ << ": the output has " << outRoots.size()
+			<< " elements, but the order is " << order << "." << endl;
+
+		return false;
+	}
+
+	if (order == 0)
+		return true;
+
+	// Padded to whole blocks, of which the extra lanes are evaluated but never updated.
+	const size_t paddedSize = (order + LANE_WIDTH - 1) / LANE_WIDTH * LANE_WIDTH;
+
+	std::vector<HReal> re(paddedSize);
+	std::vector<HReal> im(paddedSize);
+	std::vector<HReal> valueRe(order);
+	std::vector<HReal> valueIm(order);
+	std::vector<HReal> derivativeRe(order);
+	std::vector<HReal> derivativeIm(order);
+	std::vector<HReal> bounds(order);
+	std::vector<uint8_t> converged(order);
+
+	getInitialEstimates(coeffs.data(), order, re.data(), im.data(), 1);
+
+	size_t numConverged = 0;
+	Evaluation evaluation;
+
+	while (numConverged < order && outIterationCount < maxCount)
+	{
+		++outIterationCount;
+
+		for (size_t block = 0; block < order; block += LANE_WIDTH)
+		{
+			const size_t width = std::min(LANE_WIDTH, order - block);
+			evaluateLanes<true>(evaluation, coeffs.data(), coeffs.size(), re.data() + block, im.data() + block);
+
+			std::copy_n(evaluation.valueRe, width, valueRe.data() + block);
+			std::copy_n(evaluation.valueIm, width, valueIm.data() + block);
+			std::copy_n(evaluation.derivativeRe, width, derivativeRe.data() + block);
+			std::copy_n(evaluation.derivativeIm, width, derivativeIm.data() + block);
+			std::copy_n(evaluation.bound, width, bounds.data() + block);
+		}
+
+		// Steps are applied in place, so that later roots see the updated estimates.
+		for (size_t k = 0; k < order; ++k)
+		{
+			if (converged[k])
+				continue;
+
+			const TComplex value(valueRe[k], valueIm[k]);
+			if (std::abs(value) <= epsilon * bounds[k])
+			{
+				converged[k] = 1;
+				++numConverged;
+				continue;
+			}
+
+			const TComplex z(re[k], im[k]);
+			TComplex sum;
+
+			for (size_t j = 0; j < order; ++j)
+			{
+				if (j != k)
+				{
+					sum += ONE / (z - TComplex(re[j], im[j]));
+				}
+			}
+
+			const TComplex denominator = TComplex(derivativeRe[k], derivativeIm[k]) - value * sum;
+			if (denominator == TComplex())
+				continue;
+
+			const TComplex step = value / denominator;
+			const TComplex newZ = z - step;
+
+			re[k] = newZ.real();
+			im[k] = newZ.imag();
+
+			if (std::abs(step) <= epsilon * std::abs(newZ))
+			{
+				converged[k] = 1;
+				++numConverged;
+			}
+		}
+	}
+
+	for (size_t k = 0; k < order; ++k)
+	{
+		outRoots[k] = TComplex(re[k], im[k]);
+	}
+
+	return numConverged == order;
+}
+
+size_t aberthMethod(std::span<int> outIterationCounts, std::span<TComplex> outRoots,
+	std::span<const Polynomial> polynomials, int maxCount, HReal epsilon)
+{
+	using namespace std;
+
+	const size_t count = polynomials.size();
+	if (count == 0)
+		return 0;
+
+	const int numCoeffs = polynomials[0].numCoefficients();
+	const size_t order = numCoeffs > 0 ? static_cast<size_t>(numCoeffs - 1) : 0;
+
+	for (const auto& polynomial : polynomials)
+	{
+		if (polynomial.numCoefficients() != numCoeffs || (numCoeffs > 0 && polynomial.getCoefficient(0) == ZERO))
+		{
+			cerr << "[hmath][roots][Error] " << __func__
+				<< ": every polynomial should have the same order and a non-zero leading coefficient." << endl;
+
+			return 0;
+		}
+	}
+
+	if (outIterationCounts.size() < count || outRoots.size() < count * order)
+	{
+		cerr << "[hmath][roots][Error] " << __func__ << ": the outputs have " << outIterationCounts.size()
+			<< " and " << outRoots.size() << " elements, but " << count << " polynomials of order "
+			<< order << " are given." << endl;
+
+		return 0;
+	}
+
+	if (order == 0)
+	{
+		std::fill_n(outIterationCounts.begin(), count, 0);
+		return count;
+	}
+
+	// Structure of arrays, element i * LANE_WIDTH + lane belongs to the polynomial of the lane.
+	std::vector<HReal> coeffs((order + 1) * LANE_WIDTH);
+	std::vector<HReal> re(order * LANE_WIDTH);
+	std::vector<HReal> im(order * LANE_WIDTH);
+	std::vector<uint8_t> converged(order * LANE_WIDTH);
+	std::vector<HReal> monic;
+
+	size_t numSolved = 0;
+	Evaluation evaluation;
+
+	for (size_t block = 0; block < count; block += LANE_WIDTH)
+	{
+		const size_t width = std::min(LANE_WIDTH, count - block);
+
+		// Padding lanes repeat the first polynomial of the block, and are marked converged.
+		for (size_t lane = 0; lane < LANE_WIDTH; ++lane)
+		{
+			const bool bPadding = lane >= width;
+			getMonicCoefficients(monic, polynomials[block + (bPadding ? 0 : lane)], __func__);
+
+			for (size_t i = 0; i <= order; ++i)
+			{
+				coeffs[i * LANE_WIDTH + lane] = monic[i];
+			}
+
+			getInitialEstimates(monic.data(), order, re.data() + lane, im.data() + lane, LANE_WIDTH);
+
+			for (size_t k = 0; k < order; ++k)
+			{
+				converged[k * LANE_WIDTH + lane] = bPadding;
+			}
+		}
+
+		size_t numLeft[LANE_WIDTH];
+		for (size_t lane = 0; lane < LANE_WIDTH; ++lane)
+		{
+			numLeft[lane] = lane < width ? order : 0;
+		}
+
+		std::fill_n(outIterationCounts.begin() + block, width, -1);
+
+		size_t numLanesLeft = width;
+
+		for (int iteration = 1; iteration <= maxCount && numLanesLeft > 0; ++iteration)
+		{
+			for (size_t k = 0; k < order; ++k)
+			{
+				HReal* zRe = re.data() + k * LANE_WIDTH;
+				HReal* zIm = im.data() + k * LANE_WIDTH;
+
+				evaluateLanes<false>(evaluation, coeffs.data(), order + 1, zRe, zIm);
+
+				HReal sumRe[LANE_WIDTH] = {};
+				HReal sumIm[LANE_WIDTH] = {};
+
+				for (size_t j = 0; j < order; ++j)
+				{
+					if (j == k)
+						continue;
+
+					const HReal* otherRe = re.data() + j * LANE_WIDTH;
+					const HReal* otherIm = im.data() + j * LANE_WIDTH;
+
+					for (size_t lane = 0; lane < LANE_WIDTH; ++lane)
+					{
+						// 1 / d = conj(d) / |d|^2
+						const HReal dRe = zRe[lane] - otherRe[lane];
+						const HReal dIm = zIm[lane] - otherIm[lane];
+						const HReal invNorm = ONE / (dRe * dRe + dIm * dIm);
+
+						sumRe[lane] += dRe * invNorm;
+						sumIm[lane] -= dIm * invNorm;
+					}
+				}
+
+				uint8_t* rootConverged = converged.data() + k * LANE_WIDTH;
+
+				for (size_t lane = 0; lane < LANE_WIDTH; ++lane)
+				{
+					if (rootConverged[lane])
+						continue;
+
+					const HReal pRe = evaluation.valueRe[lane];
+					const HReal pIm = evaluation.valueIm[lane];
+
+					bool bConverged = std::sqrt(pRe * pRe + pIm * pIm) <= epsilon * evaluation.bound[lane];
+
+					// denominator = p' - p * sum, step = p / denominator
+					const HReal denomRe = evaluation.derivativeRe[lane] - (pRe * sumRe[lane] - pIm * sumIm[lane]);
+					const HReal denomIm = evaluation.derivativeIm[lane] - (pRe * sumIm[lane] + pIm * sumRe[lane]);
+					const HReal denomNorm = denomRe * denomRe + denomIm * denomIm;
+
+					if (!bConverged && denomNorm > ZERO)
+					{
+						const HReal stepRe = (pRe * denomRe + pIm * denomIm) / denomNorm;
+						const HReal stepIm = (pIm * denomRe - pRe * denomIm) / denomNorm;
+
+						zRe[lane] -= stepRe;
+						zIm[lane] -= stepIm;
+
+						const HReal stepNorm = std::sqrt(stepRe * stepRe + stepIm * stepIm);
+						const HReal zNorm = std::sqrt(zRe[lane] * zRe[lane] + zIm[lane] * zIm[lane]);
+						bConverged = stepNorm <= epsilon * zNorm;
+					}
+
+					if (!bConverged)
+						continue;
+
+					rootConverged[lane] = 1;
+
+					if (--numLeft[lane] == 0)
+					{
+						outIterationCounts[block + lane] = iteration;
+						--numLanesLeft;
+						++numSolved;
+					}
+				}
+			}
+		}
+
+		for (size_t lane = 0; lane < width; ++lane)
+		{
+			TComplex* laneRoots = outRoots.data() + (block + lane) * order;
+
+			for (size_t k = 0; k < order; ++k)
+			{
+				laneRoots[k] = TComplex(re[k * LANE_WIDTH + lane], im[k * LANE_WIDTH + lane]);
+			}
+		}
+	}
+
+	return numSolved;
+}
+
+SturmSequence::SturmSequence()
+	: numPolynomials(0)
+{
+}
+
+SturmSequence::SturmSequence(const Polynomial& polynomial)
+	: numPolynomials(0)
+{
+	build(polynomial);
+}
+
+void SturmSequence::build(const Polynomial& polynomial)
+{
+	// Polynomials beyond numPolynomials are kept, so that their storage is reused by later builds.
+	auto getSlot = [this](size_t index) -> Polynomial&
+	{
+		if (index >= sequence.size())
+		{
+			sequence.resize(index + 1);
+		}
+
+		return sequence[index];
+	};
+
+	Polynomial& first = getSlot(0);
+	first = polynomial;
+	first.trim();
+	first.normalize();
+
+	numPolynomials = 1;
+	squarefree = first;
+
+	if (first.getOrder() < 1)
+		return;
+
+	Polynomial& second = getSlot(1);
+	second = sequence[0];
+	second.defferentiate();
+	second.normalize();
+
+	numPolynomials = 2;
+
+	while (sequence[numPolynomials - 1].getOrder() > 0)
+	{
+		Polynomial& next = getSlot(numPolynomials);
+		sequence[numPolynomials - 2].remainder(sequence[numPolynomials - 1], next);
+
+		// The dividend is normalized, so the tolerance is relative to its largest coefficient.
+		next.trim(TRIM_TOLERANCE);
+		if (next.numCoefficients() == 0)
+			break;
+
+		next *= MINUS_ONE;
+		next.normalize();
+
+		++numPolynomials;
+	}
+
+	// The last polynomial is gcd(p, p') up to a constant factor.
+	sequence[0].divide(sequence[numPolynomials - 1], squarefree, scratch);
+	squarefree.normalize();
+}
+
+size_t SturmSequence::size() const
+{
+	return numPolynomials;
+}
+
+const Polynomial& SturmSequence::operator[] (size_t index) const
+{
+	return sequence[index];
+}
+
+int SturmSequence::countSignChanges(HReal x) const
+{
+	int count = 0;
+	bool bHasSign = false;
+	bool bNegative = false;
+
+	// Zeros are skipped, so that a root at x is counted on the interval ending at x.
+	for (size_t i = 0; i < numPolynomials; ++i)
+	{
+		const HReal y = sequence[i].evaluate(x);
+		if (y == ZERO)
+			continue;
+
+		if (bHasSign && std::signbit(y) != bNegative)
+		{
+			++count;
+		}
+
+		bHasSign = true;
+		bNegative = std::signbit(y);
+	}
+
+	return count;
+}
+
+int SturmSequence::countSignChangesAtInfinity(bool bNegativeInfinity) const
+{
+	int count = 0;
+	bool bHasSign = false;
+	bool bNegative = false;
+
+	// The sign at infinity is the one of the leading term.
+	for (size_t i = 0; i < numPolynomials; ++i)
+	{
+		const Polynomial& polynomial = sequence[i];
+		if (polynomial.numCoefficients() == 0)
+			continue;
+
+		const bool bOddOrder = polynomial.getOrder() % 2 != 0;
+		const bool bLeadingNegative = std::signbit(polynomial.getCoefficient(0));
+		const bool bSignNegative = bLeadingNegative != (bNegativeInfinity && bOddOrder);
+
+		if (bHasSign && bSignNegative != bNegative)
+		{
+			++count;
+		}
+
+		bHasSign = true;
+		bNegative = bSignNegative;
+	}
+
+	return count;
+}
+
+int SturmSequence::countRoots(HReal low, HReal high) const
+{
+	if (!(low < high))
+		return 0;
+
+	return countSignChanges(low) - countSignChanges(high);
+}
+
+int SturmSequence::countRoots() const
+{
+	return countSignChangesAtInfinity(true) - countSignChangesAtInfinity(false);
+}
+
+HReal SturmSequence::getRootBound() const
+{
+	if (numPolynomials == 0 || sequence[0].numCoefficients() == 0)
+		return ZERO;
+
+	const Polynomial& polynomial = sequence[0];
+	const HReal leading = std::abs(polynomial.getCoefficient(0));
+
+	HReal ratio = ZERO;
+	for (int i = 1; i < polynomial.numCoefficients(); ++i)
+	{
+		ratio = std::max(ratio, std::abs(polynomial.getCoefficient(i)) / leading);
+	}
+
+	return ONE + ratio;
+}
+
+void SturmSequence::isolateRoots(std::vector<RootInterval>& outIntervals)
+{
+	outIntervals.clear();
+	brackets.clear();
+
+	if (numPolynomials < 2)
+		return;
+
+	const HReal bound = getRootBound();
+	brackets.push_back(Bracket{ -bound, bound, countSignChanges(-bound), countSignChanges(bound) });
+
+	// Depth-first, the lower half first, so that the intervals come out in ascending order.
+	while (!brackets.empty())
+	{
+		const Bracket bracket = brackets.back();
+		brackets.pop_back();
+
+		const int numRoots = bracket.lowCount - bracket.highCount;
+		if (numRoots <= 0)
+			continue;
+
+		const HReal middle = bracket.low + (bracket.high - bracket.low) * HALF;
+		const bool bSplittable = bracket.low < middle && middle < bracket.high;
+
+		if (numRoots == 1 || !bSplittable)
+		{
+			outIntervals.push_back(RootInterval{ bracket.low, bracket.high, numRoots });
+			continue;
+		}
+
+		const int middleCount = countSignChanges(middle);
+
+		brackets.push_back(Bracket{ middle, bracket.high, middleCount, bracket.highCount });
+		brackets.push_back(Bracket{ bracket.low, middle, bracket.lowCount, middleCount });
+	}
+}
+
+void SturmSequence::findRealRoots(std::vector<HRoot>& outRoots, HReal epsilon)
+{
+	outRoots.clear();
+	isolateRoots(intervals);
+
+	auto func = [this](HReal x) -> HReal
+	{
+		return squarefree.evaluate(x);
+	};
+
+	for (const auto& interval : intervals)
+	{
+		int count = 0;
+		const auto root = analysis::brentMethod(count, func, interval.low, interval.high, 100, epsilon);
+
+		if (root)
+		{
+			outRoots.push_back(*root);
+			continue;
+		}
+
+		HReal low = interval.low;
+		HReal high = interval.high;
+		HReal lowY = func(low);
+		HReal highY = func(high);
+
+		while (true)
+		{
+			const HReal middle = low + (high - low) * HALF;
+			if (!(low < middle && middle < high))
+				break;
+
+			const HReal y = func(middle);
+			if (std::signbit(y) == std::signbit(lowY))
+			{
+				low = middle;
+				lowY = y;
+			}
+			else
+			{
+				high = middle;
+				highY = y;
+			}
+		}
+
+		if (std::abs(lowY) < std::abs(highY))
+		{
+			outRoots.emplace_back(low, std::abs(lowY));
+		}
+		else
+		{
+			outRoots.emplace_back(high, std::abs(highY));
+		}
+	}
+}
+
+#if DO_TEST
+int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
+{
+	using namespace std;
+	using Clock = std::chrono::steady_clock;
+
+	int errorCount = 0;
+
+	auto report = [&](int line, const string& text)
+	{
+		++errorCount;
+
+		ostringstream msg;
+		msg << "[roots][TC" << inOutTestCount << "][Error] " << line << ": " << text << endl;
+
+		const auto errorMsg = msg.view();
+		cerr << errorMsg;
+
+		outErrorMessages.emplace_back(errorMsg);
+	};
+
+	// Product of (x - r) over the real roots and (x^2 - 2 Re(c) x + |c|^2) over the complex ones.
+	auto fromRoots = [](std::span<const TComplex> trueRoots) -> Polynomial
+	{
+		Polynomial polynomial{ ONE };
+
+		for (const auto& root : trueRoots)
+		{
+			if (root.imag() == ZERO)
+			{
+				polynomial *= Polynomial{ ONE, -root.real() };
+			}
+			else if (root.imag() > ZERO)
+			{
+				polynomial *= Polynomial{ ONE, -TWO * root.real(), std::norm(root) };
+			}
+		}
+
+		return polynomial;
+	};
+
+	// Largest distance from a true root to the nearest found root.
+	auto getMaxError = [](std::span<const TComplex> foundRoots, std::span<const TComplex> trueRoots) -> HReal
+	{
+		HReal maxError = ZERO;
+
+		for (const auto& trueRoot : trueRoots)
+		{
+			HReal error = MAX_NUMBER;
+			for (const auto& root : foundRoots)
+			{
+				error = std::min(error, std::abs(root - trueRoot));
+			}
+
+			maxError = std::max(maxError, error);
+		}
+
+		return maxError;
+	};
+
+	{
+		cout << endl << "[roots][TC" << ++inOutTestCount << "] Complex evaluation" << endl;
+
+		const Polynomial polynomial{ 2, -3, 0, 1.5, -1, 4 };
+
+		vector<TComplex> values;
+		for (int i = 0; i < 37; ++i)
+		{
+			values.emplace_back(-2 + 0.1 * i, 1.5 - 0.08 * i);
+		}
+
+		vector<TComplex> ys(values.size());
+		vector<TComplex> dys(values.size());
+		evaluate(polynomial, values, ys, dys);
+
+		HReal maxError = ZERO;
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			TComplex y = polynomial.getCoefficient(0);
+			TComplex dy;
+
+			for (int j = 1; j < polynomial.numCoefficients(); ++j)
+			{
+				dy = dy * values[i] + y;
+				y = y * values[i] + polynomial.getCoefficient(j);
+			}
+
+			maxError = std::max({ maxError, std::abs(ys[i] - y), std::abs(dys[i] - dy) });
+		}
+
+		cout << "[roots][TC" << inOutTestCount << "] max error = " << maxError << endl;
+
+		if (maxError > 1e-12)
+		{
+			report(__LINE__, "complex evaluation differs from std::complex, error = " + to_string(maxError));
+		}
+	}
+
+	{
+		cout << endl << "[roots][TC" << ++inOutTestCount << "] Aberth-Ehrlich method" << endl;
+
+		struct Case final
+		{
+			const char* name;
+			vector<TComplex> trueRoots;
+			HReal tolerance;
+		};
+
+		const vector<Case> cases = {
+			{ "real and complex roots", { 1, -2, 3, { 0, 1 }, { 0, -1 }, { 1, 2 }, { 1, -2 } }, 1e-10 },
+			{ "roots 1 to 10", { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }, 1e-6 },
+			{ "zero root", { 0, 1, -1 }, 1e-12 },
+			{ "double root", { 1, 1, -1, 2 }, 1e-6 },
+			{ "clustered roots", { 0.99, 1, 1.01, { 5, 0.5 }, { 5, -0.5 } }, 1e-8 },
+		};
+
+		for (const auto& testCase : cases)
+		{
+			const Polynomial polynomial = fromRoots(testCase.trueRoots) * 3;
+
+			vector<TComplex> foundRoots(polynomial.getOrder());
+			int count = 0;
+			const bool bConverged = aberthMethod(count, foundRoots, polynomial);
+			const HReal maxError = getMaxError(foundRoots, testCase.trueRoots);
+
+			cout << "[roots][TC" << inOutTestCount << "] " << testCase.name << ": converged = " << bConverged
+				<< ", iterations = " << count << ", max error = " << maxError << endl;
+
+			if (!bConverged || maxError > testCase.tolerance)
+			{
+				report(__LINE__, string(testCase.name) + ": failed to find every root, error = " + to_string(maxError));
+			}
+		}
+
+		// Newton's method finds at most one real root per start point.
+		const Polynomial polynomial = fromRoots(cases[0].trueRoots);
+
+		int newtonCount = 0;
+		const auto newtonRoot = analysis::newtonRaphsonMethod(newtonCount, polynomial.AsFunction(), 0.5);
+
+		cout << "[roots][TC" << inOutTestCount << "] Newton-Raphson from 0.5: "
+			<< (newtonRoot ? newtonRoot->value : NAN) << ", iterations = " << newtonCount << endl;
+
+		vector<TComplex> foundRoots(1);
+		int count = 0;
+		if (aberthMethod(count, foundRoots, Polynomial{ 0, 1, 2 }))
+		{
+			report(__LINE__, "a zero leading coefficient SHOULD be rejected.");
+		}
+	}
+
+	{
+		cout << endl << "[roots][TC" << ++inOutTestCount << "] Batch Aberth-Ehrlich method" << endl;
+
+		constexpr size_t count = 2003;
+		constexpr size_t order = 6;
+
+		vector<Polynomial> polynomials;
+		vector<TComplex> trueRoots;
+		polynomials.reserve(count);
+		trueRoots.reserve(count * order);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const HReal t = static_cast<HReal>(i);
+			const TComplex roots[order] = {
+				-3 + std::fmod(t * 0.37, 2.0),
+				std::fmod(t * 0.61, 1.5),
+				2 + std::fmod(t * 0.13, 1.0),
+				4 - std::fmod(t * 0.29, 0.5),
+				{ std::fmod(t * 0.17, 2.0) - 1, 0.5 + std::fmod(t * 0.07, 1.0) },
+				{ std::fmod(t * 0.17, 2.0) - 1, -0.5 - std::fmod(t * 0.07, 1.0) } };
+
+			polynomials.push_back(fromRoots(roots));
+			trueRoots.insert(trueRoots.end(), roots, roots + order);
+		}
+
+		vector<TComplex> batchRoots(count * order);
+		vector<int> iterationCounts(count);
+
+		const auto batchStart = Clock::now();
+		const size_t numSolved = aberthMethod(iterationCounts, batchRoots, polynomials);
+		const chrono::duration<double, milli> batchTime = Clock::now() - batchStart;
+
+		vector<TComplex> scalarRoots(count * order);
+		size_t numScalarSolved = 0;
+
+		const auto scalarStart = Clock::now();
+		for (size_t i = 0; i < count; ++i)
+		{
+			int iterationCount = 0;
+			numScalarSolved += aberthMethod(iterationCount, span(scalarRoots).subspan(i * order, order), polynomials[i]);
+		}
+		const chrono::duration<double, milli> scalarTime = Clock::now() - scalarStart;
+
+		HReal maxError = ZERO;
+		HReal maxScalarError = ZERO;
+		int maxIterations = 0;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const auto truth = span(trueRoots).subspan(i * order, order);
+			maxError = std::max(maxError, getMaxError(span(batchRoots).subspan(i * order, order), truth));
+			maxScalarError = std::max(maxScalarError, getMaxError(span(scalarRoots).subspan(i * order, order), truth));
+			maxIterations = std::max(maxIterations, iterationCounts[i]);
+		}
+
+		cout << "[roots][TC" << inOutTestCount << "] solved = " << numSolved << " / " << count
+			<< ", max iterations = " << maxIterations << ", max error = " << maxError
+			<< ", scalar max error = " << maxScalarError << endl;
+		cout << "[roots][TC" << inOutTestCount << "] batch = " << batchTime.count() << " ms, scalar = "
+			<< scalarTime.count() << " ms" << endl;
+
+		if (numSolved != count || numScalarSolved != count || maxError > 1e-8 || maxScalarError > 1e-8)
+		{
+			report(__LINE__, "batch roots are wrong, solved = " + to_string(numSolved) + ", error = " + to_string(maxError));
+		}
+
+		if (std::count(iterationCounts.begin(), iterationCounts.end(), -1) > 0)
+		{
+			report(__LINE__, "a solved polynomial SHOULD report its iteration count.");
+		}
+	}
+
+	{
+		cout << endl << "[roots][TC" << ++inOutTestCount << "] Sturm sequence" << endl;
+
+		struct Case final
+		{
+			const char* name;
+			vector<TComplex> trueRoots;
+			vector<HReal> realRoots;
+			HReal tolerance;
+		};
+
+		const vector<Case> cases = {
+			{ "real and complex roots", { 1, -2, 3, { 0, 1 }, { 0, -1 } }, { -2, 1, 3 }, 1e-12 },
+			{ "multiple roots", { 1, 1, -1, 2, 2, 2 }, { -1, 1, 2 }, 1e-10 },
+			{ "roots 1 to 10", { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }, { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }, 1e-8 },
+			{ "clustered roots", { 0.99, 1, 1.01, { 5, 0.5 }, { 5, -0.5 } }, { 0.99, 1, 1.01 }, 1e-7 },
+			{ "no real root", { { 1, 2 }, { 1, -2 } }, {}, 0 },
+		};
+
+		SturmSequence sturm;
+		vector<RootInterval> intervals;
+		vector<HRoot> foundRoots;
+
+		for (const auto& testCase : cases)
+		{
+			sturm.build(fromRoots(testCase.trueRoots) * -2);
+			sturm.isolateRoots(intervals);
+			sturm.findRealRoots(foundRoots);
+
+			const auto& realRoots = testCase.realRoots;
+			bool bIsolated = intervals.size() == realRoots.size();
+
+			for (size_t i = 0; bIsolated && i < realRoots.size(); ++i)
+			{
+				bIsolated = intervals[i].numRoots == 1 && intervals[i].low < realRoots[i] && realRoots[i] <= intervals[i].high;
+			}
+
+			HReal maxError = ZERO;
+			for (size_t i = 0; i < std::min(foundRoots.size(), realRoots.size()); ++i)
+			{
+				maxError = std::max(maxError, std::abs(foundRoots[i].value - realRoots[i]));
+			}
+
+			const int numRoots = sturm.countRoots();
+
+			cout << "[roots][TC" << inOutTestCount << "] " << testCase.name << ": sequence = " << sturm.size()
+				<< ", real roots = " << numRoots << ", isolated = " << bIsolated << ", max error = " << maxError << endl;
+
+			if (numRoots != static_cast<int>(realRoots.size()) || !bIsolated
+				|| foundRoots.size() != realRoots.size() || maxError > testCase.tolerance)
+			{
+				report(__LINE__, string(testCase.name) + ": failed to isolate the real roots, count = "
+					+ to_string(numRoots) + ", error = " + to_string(maxError));
+			}
+		}
+
+		// A root at an end point is counted on the interval ending at it.
+		sturm.build(fromRoots(cases[0].trueRoots));
+		if (sturm.countRoots(0.5, 3.5) != 2 || sturm.countRoots(-2, 1) != 1 || sturm.countRoots(3, 10) != 0)
+		{
+			report(__LINE__, "roots on (a, b] are miscounted.");
+		}
+	}
+
+	{
+		cout << endl << "[roots][TC" << ++inOutTestCount << "] Allocation-free root isolation" << endl;
+
+		// Order 10, beyond the inline capacity of Polynomial.
+		constexpr size_t count = 1000;
+		constexpr size_t order = 10;
+
+		vector<Polynomial> polynomials;
+		polynomials.reserve(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const HReal t = static_cast<HReal>(i);
+
+			TComplex roots[order];
+			for (size_t k = 0; k < order; ++k)
+			{
+				roots[k] = -5 + static_cast<HReal>(k) + std::fmod(t * 0.37 + k * 0.11, 0.9);
+			}
+
+			polynomials.push_back(fromRoots(roots));
+		}
+
+		SturmSequence sturm;
+		vector<HRoot> foundRoots;
+		foundRoots.reserve(order);
+
+		sturm.build(polynomials[0]);
+		sturm.findRealRoots(foundRoots);
+
+		size_t numRoots = 0;
+		const auto startCount = GetAllocationCount();
+		const auto startTime = Clock::now();
+
+		for (const auto& polynomial : polynomials)
+		{
+			sturm.build(polynomial);
+			sturm.findRealRoots(foundRoots);
+
+			numRoots += foundRoots.size();
+		}
+
+		const chrono::duration<double, milli> elapsed = Clock::now() - startTime;
+		const auto numAllocations = GetAllocationCount() - startCount;
+
+		cout << "[roots][TC" << inOutTestCount << "] roots = " << numRoots << ", allocations = " << numAllocations
+			<< ", time = " << elapsed.count() << " ms" << endl;
+
+		if (numRoots != count * order || numAllocations != 0)
+		{
+			report(__LINE__, "isolation of " + to_string(numRoots) + " roots made " + to_string(numAllocations)
+				+ " allocations.");
+		}
+	}
+
+	return errorCount;
+}
+#endif // DO_TEST
+
+} // roots
+
+} // hmath
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "hmathconfig.h"
+#include "hmathconstants.h"
+#include "hmathpolynomial.h"
+#include "hmathtypes.h"
+
+#include <complex>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace hmath
+{
+
+// Root finders specific to polynomials, which find every root at once rather than one per start point.
+namespace roots
+{
+	using TComplex = std::complex<HReal>;
+
+	static constexpr size_t LANE_WIDTH = 8;
+
+	// Relative accuracy of the roots, a few units in the last place.
+	static constexpr HReal ROOT_EPSILON = MACHINE_EPSILON * 8;
+
+	// Evaluates p and p' at every value by Horner's method, LANE_WIDTH values at a time
+	// with the real and imaginary parts in separate arrays, so that the loops vectorize.
+	// The outputs should have at least as many elements as values.
+	void evaluate(const Polynomial& polynomial, std::span<const TComplex> values,
+		std::span<TComplex> outValues, std::span<TComplex> outDerivatives);
+
+	// conditions
+	// The leading coefficient should not be zero.
+	// outRoots should have at least getOrder() elements.
+
+	// Aberth-Ehrlich method, refining an estimate of every complex root together.
+	// Each step is Newton's step corrected by the other estimates,
+	//   z_k -= p(z_k) / (p'(z_k) - p(z_k) * sum_{j != k} 1 / (z_k - z_j)),
+	// which converges cubically to simple roots and linearly to multiple ones.
+	// A root has converged once its step is below epsilon * |z_k|, or once |p(z_k)| is below
+	// epsilon * sum |a_i| |z_k|^i, the order of the rounding error of Horner's method.
+	// Returns whether every root has converged within maxCount iterations,
+	// and the last estimates are left in outRoots otherwise.
+	bool aberthMethod(int& outIterationCount, std::span<TComplex> outRoots, const Polynomial& polynomial,
+		int maxCount = 100, HReal epsilon = ROOT_EPSILON);
+
+	// Aberth-Ehrlich method on many polynomials of the same order.
+	// Blocks of LANE_WIDTH polynomials iterate together, one polynomial per lane,
+	// so that the evaluation and the steps vectorize across polynomials.
+	// The roots of polynomial i are written to outRoots[i * order, (i + 1) * order).
+	// outIterationCounts[i] is the number of iterations of polynomial i, or -1 if it hasn't converged.
+	// Returns the number of polynomials of which every root has converged.
+	size_t aberthMethod(std::span<int> outIterationCounts, std::span<TComplex> outRoots,
+		std::span<const Polynomial> polynomials, int maxCount = 100, HReal epsilon = ROOT_EPSILON);
+
+	// Interval (low, high] holding numRoots distinct real roots,
+	// which is one unless the roots are too close to be separated in floating point.
+	struct RootInterval final
+	{
+		HReal low;
+		HReal high;
+		int numRoots;
+	};
+
+	// Sturm sequence p_0 = p, p_1 = p', p_k+1 = -rem(p_k-1, p_k), of which the number of sign changes V(x)
+	// gives the number of distinct real roots on (a, b] as V(a) - V(b), multiple roots counted once.
+	// It also serves as a workspace: the polynomials, the bisection stack and the squarefree part
+	// keep their storage between builds, so that isolating roots of many polynomials of similar orders
+	// doesn't allocate once the capacity suffices.
+	class SturmSequence final
+	{
+	public:
+		// Remainder coefficients below this, relative to the largest coefficient of the dividend, are rounding noise.
+		static constexpr HReal TRIM_TOLERANCE = MACHINE_EPSILON * 1024;
+
+	private:
+		struct Bracket final
+		{
+			HReal low;
+			HReal high;
+			int lowCount;
+			int highCount;
+		};
+
+		std::vector<Polynomial> sequence;
+		size_t numPolynomials;
+
+		// p / gcd(p, p'), which has the same roots as p, all simple.
+		Polynomial squarefree;
+		Polynomial scratch;
+		std::vector<Bracket> brackets;
+		std::vector<RootInterval> intervals;
+
+	public:
+		SturmSequence();
+		explicit SturmSequence(const Polynomial& polynomial);
+		~SturmSequence() = default;
+
+		// Rebuilds the sequence of the polynomial, reusing the storage of the previous one.
+		void build(const Polynomial& polynomial);
+
+		size_t size() const;
+		const Polynomial& operator[] (size_t index) const;
+
+		int countSignChanges(HReal x) const;
+
+		// Number of distinct real roots on (low, high].
+		int countRoots(HReal low, HReal high) const;
+
+		// Number of distinct real roots.
+		int countRoots() const;
+
+		// Every real root is within (-bound, bound), by Cauchy's bound 1 + max |a_i / a_0|.
+		HReal getRootBound() const;
+
+		// Bisects (-bound, bound] until each interval holds one root, in ascending order.
+		void isolateRoots(std::vector<RootInterval>& outIntervals);
+
+		// Isolates the roots, then polishes each in its interval by analysis::brentMethod on the squarefree part,
+		// which changes sign at every root, including the ones of even multiplicity.
+		// Where Brent's method can't reach |f| < epsilon, the interval is bisected to machine precision instead.
+		// The errors are |f| of the squarefree part, of which the largest coefficient is scaled into [1, 2).
+		void findRealRoots(std::vector<HRoot>& outRoots, HReal epsilon = NANO * MILI);
+
+	private:
+		int countSignChangesAtInfinity(bool bNegative) const;
+	};
+
+#if DO_TEST
+	int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
+#endif // DO_TEST
+
+} // roots
+
+} // hmath
@@ -1,31 +1,55 @@
+#pragma once
 
+#include "hmathconstants.h"
 #include "hmathtypes.h"
 
-#include <initializer_list>
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
 
 
 namespace hmath
 {
+	// Polynomial of which order is fixed at compile time.
+	// Coefficients are in descending order as Polynomial, and evaluation is fully unrolled.
 	template <int Order = 1>
 	class StaticPolynomial final
 	{
 		static_assert(Order >= 0);
 
+		template <int OtherOrder>
+		friend class StaticPolynomial;
+
+	public:
+		static constexpr int NUM_COEFFICIENTS = Order + 1;
+
 	private:
-		HReal coefficients[Order];
+		std::array<HReal, NUM_COEFFICIENTS> coefficients;
 
 	public:
-		StaticPolynomial() = default;
-		StaticPolynomial(std::initializer_list inCoefficients)
+		constexpr StaticPolynomial()
+			: coefficients{}
+		{
+		}
+
+		template <typename... TArgs>
+			requires (sizeof...(TArgs) == NUM_COEFFICIENTS && (std::is_convertible_v<TArgs, HReal> && ...))
+		constexpr StaticPolynomial(TArgs... inCoefficients)
+			: coefficients{ static_cast<HReal>(inCoefficients)... }
+		{
+		}
+
+		constexpr explicit StaticPolynomial(const std::array<HReal, NUM_COEFFICIENTS>& inCoefficients)
 			: coefficients(inCoefficients)
 		{
 		}
 
 		~StaticPolynomial() = default;
 
-		bool operator== (const StaticPolynomial& rhs) const
+		constexpr bool operator== (const StaticPolynomial& rhs) const
 		{
-			for (int i = 0; i < Order; ++i)
+			for (int i = 0; i < NUM_COEFFICIENTS; ++i)
 			{
 				if (coefficients[i] != rhs.coefficients[i])
 					return false;
@@ -34,32 +58,136 @@ namespace hmath
 			return true;
 		}
 
-		bool operator!= (const StaticPolynomial& rhs) const
+		constexpr bool operator!= (const StaticPolynomial& rhs) const
 		{
 			return !(*this == rhs);
 		}
 
+		template <int RhsOrder>
+		constexpr auto operator+ (const StaticPolynomial<RhsOrder>& rhs) const
+		{
+			StaticPolynomial<std::max(Order, RhsOrder)> outcome;
+			outcome.template addAligned<Order>(coefficients, ONE);
+			outcome.template addAligned<RhsOrder>(rhs.coefficients, ONE);
+
+			return outcome;
+		}
+
+		template <int RhsOrder>
+		constexpr auto operator- (const StaticPolynomial<RhsOrder>& rhs) const
+		{
+			StaticPolynomial<std::max(Order, RhsOrder)> outcome;
+			outcome.template addAligned<Order>(coefficients, ONE);
+			outcome.template addAligned<RhsOrder>(rhs.coefficients, MINUS_ONE);
+
+			return outcome;
+		}
+
+		template <int RhsOrder>
+		constexpr auto operator* (const StaticPolynomial<RhsOrder>& rhs) const
+		{
+			StaticPolynomial<Order + RhsOrder> outcome;
+
+			for (int i = 0; i <= Order; ++i)
+			{
+				for (int j = 0; j <= RhsOrder; ++j)
+				{
+					outcome.coefficients[i + j] += coefficients[i] * rhs.coefficients[j];
+				}
+			}
+
+			return outcome;
+		}
+
+		constexpr StaticPolynomial operator* (HReal value) const
+		{
+			StaticPolynomial outcome(*this);
+
+			for (auto& coeff : outcome.coefficients)
+			{
+				coeff *= value;
+			}
+
+			return outcome;
+		}
+
 	public:
-		constexpr int getOrder() const { return Order; }
+		static constexpr int getOrder() { return Order; }
+		static constexpr int numCoefficients() { return NUM_COEFFICIENTS; }
 
-		HReal getCoefficient(int index) const
+		constexpr HReal getCoefficient(int index) const
 		{
-			if (index < 0 || index >= getOrder())
+			if (index < 0 || index >= NUM_COEFFICIENTS)
 				return ZERO;
 
-			return coefficients.at(index);
+			return coefficients[index];
+		}
+
+		constexpr HReal evaluate(HReal value) const
+		{
+			return evaluateHorner(value, std::make_index_sequence<Order>());
 		}
 
-		HReal evaluate(HReal value) const
+		constexpr HReal operator() (HReal value) const
 		{
-			HReal y = ZERO;
+			return evaluate(value);
+		}
 
-			for (auto coeff : coefficients)
+		constexpr auto derivative() const
+		{
+			if constexpr (Order == 0)
 			{
-				y = y * value + coeff;
+				return StaticPolynomial<0>();
 			}
+			else
+			{
+				StaticPolynomial<Order - 1> outcome;
+
+				for (int i = 0; i < Order; ++i)
+				{
+					outcome.coefficients[i] = coefficients[i] * (Order - i);
+				}
+
+				return outcome;
+			}
+		}
+
+		constexpr StaticPolynomial<Order + 1> integral(HReal constant = ZERO) const
+		{
+			StaticPolynomial<Order + 1> outcome;
+
+			for (int i = 0; i <= Order; ++i)
+			{
+				outcome.coefficients[i] = coefficients[i] / (NUM_COEFFICIENTS - i);
+			}
+
+			outcome.coefficients[NUM_COEFFICIENTS] = constant;
+
+			return outcome;
+		}
+
+	private:
+		// Horner's method unrolled by a fold expression over the coefficient indices.
+		template <size_t... Indices>
+		constexpr HReal evaluateHorner(HReal value, std::index_sequence<Indices...>) const
+		{
+			HReal y = coefficients[0];
+			((y = y * value + coefficients[Indices + 1]), ...);
 
 			return y;
 		}
+
+		// Adds the coefficients of a lower or equal order polynomial, aligned on the constant term.
+		template <int SourceOrder>
+		constexpr void addAligned(const std::array<HReal, SourceOrder + 1>& source, HReal scale)
+		{
+			static_assert(SourceOrder <= Order);
+			constexpr int offset = Order - SourceOrder;
+
+			for (int i = 0; i <= SourceOrder; ++i)
+			{
+				coefficients[offset + i] += source[i] * scale;
+			}
+		}
 	};
-}
\ No newline at end of file
+}
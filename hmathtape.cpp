@@ -0,0 +1,280 @@
+#include "hmathtape.h"
+
+#include "hmath.h"
+#include "hmathanalysis.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+
+namespace hmath
+{
+namespace autodiff
+{
+
+Tape::Tape(size_t blockSize)
+	: arena(blockSize), last(nullptr), numNodes(0)
+{
+}
+
+void Tape::reset()
+{
+	arena.reset();
+	last = nullptr;
+	numNodes = 0;
+}
+
+Variable Tape::createVariable(HReal value)
+{
+	return Variable(this, record(nullptr, ZERO, nullptr, ZERO), value);
+}
+
+void Tape::propagate(const Variable& output)
+{
+	if (output.tape != this || output.node == nullptr)
+		return;
+
+	for (TapeNode* node = last; node != nullptr; node = node->previous)
+	{
+		node->adjoint = ZERO;
+	}
+
+	output.node->adjoint = ONE;
+
+	// Nodes are linked from the latest one, i.e. in the reverse topological order.
+	for (TapeNode* node = last; node != nullptr; node = node->previous)
+	{
+		const HReal adjoint = node->adjoint;
+		if (adjoint == ZERO)
+			continue;
+
+		for (int i = 0; i < 2; ++i)
+		{
+			if (TapeNode* parent = node->parents[i])
+			{
+				parent->adjoint += node->partials[i] * adjoint;
+			}
+		}
+	}
+}
+
+HReal Tape::getAdjoint(const Variable& variable) const
+{
+	if (variable.tape != this || variable.node == nullptr)
+		return ZERO;
+
+	return variable.node->adjoint;
+}
+
+size_t Tape::getNumNodes() const
+{
+	return numNodes;
+}
+
+#if DO_TEST
+int Tape::DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
+{
+	using namespace std;
+
+	int errorCount = 0;
+
+	// sum of sin(x_i) x_(i+1) + exp(x_i / 100)
+	auto func = [](auto xs)
+	{
+		using std::exp;
+		using std::sin;
+
+		const size_t count = xs.size();
+		auto sum = decltype(xs[0] * xs[0])(ZERO);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			sum += sin(xs[i]) * xs[(i + 1) % count] + exp(xs[i] * CENTI);
+		}
+
+		return sum;
+	};
+
+	auto trueGradient = [](std::span<const HReal> xs, std::span<HReal> outGradient)
+	{
+		const size_t count = xs.size();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const size_t next = (i + 1) % count;
+			const size_t prev = (i + count - 1) % count;
+
+			outGradient[i] = std::cos(xs[i]) * xs[next] + std::sin(xs[prev]) + std::exp(xs[i] * CENTI) * CENTI;
+		}
+	};
+
+	{
+		cout << endl << "[Tape][TC" << ++inOutTestCount << "] Reverse-mode gradient" << endl;
+
+		constexpr size_t count = 64;
+
+		std::vector<HReal> x(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			x[i] = std::sin(static_cast<HReal>(i)) * 2;
+		}
+
+		std::vector<HReal> gradient(count);
+		std::vector<HReal> answer(count);
+
+		Tape tape;
+		const HReal value = tape.gradient(func, x, gradient);
+		trueGradient(x, answer);
+
+		HReal error = analysis::getError(value, func(std::span<const HReal>(x)));
+		for (size_t i = 0; i < count; ++i)
+		{
+			error = max(error, analysis::getError(gradient[i], answer[i]));
+		}
+
+		// The second evaluation reuses the arena.
+		const auto startCount = GetAllocationCount();
+		tape.gradient(func, x, gradient);
+		const auto numAllocations = GetAllocationCount() - startCount;
+
+		cout << "[Tape][TC" << inOutTestCount << "] " << tape.getNumNodes() << " nodes, gradient error = "
+			<< error << ", allocations in the steady state = " << numAllocations << endl;
+
+		if (error > NANO || numAllocations != 0)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[Tape][TC" << inOutTestCount << "][Error] " << __LINE__ << ": error "
+				<< error << " is bigger than expected " << NANO << ", or "
+				<< numAllocations << " allocations found" << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	{
+		cout << endl << "[Tape][TC" << ++inOutTestCount << "] Benchmark: reverse-mode vs finite differences" << endl;
+
+		using Clock = std::chrono::steady_clock;
+
+		for (size_t count : { 4, 16, 64, 256 })
+		{
+			std::vector<HReal> x(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				x[i] = std::cos(static_cast<HReal>(i));
+			}
+
+			std::vector<HReal> gradient(count);
+			std::vector<HReal> approximateGradient(count);
+
+			const int numRepeats = static_cast<int>(4096 / count);
+
+			Tape tape;
+			auto startTime = Clock::now();
+
+			for (int repeat = 0; repeat < numRepeats; ++repeat)
+			{
+				tape.gradient(func, x, gradient);
+			}
+
+			const std::chrono::duration<double, std::micro> tapeTime = Clock::now() - startTime;
+
+			// Finite differences, one coordinate at a time through analysis::derivative
+			int numEvaluations = 0;
+			std::vector<HReal> point(x);
+			startTime = Clock::now();
+
+			for (int repeat = 0; repeat < numRepeats; ++repeat)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					const TFunc1 partialFunc = [&, i](HReal xi) -> HReal
+					{
+						++numEvaluations;
+
+						point[i] = xi;
+						const HReal y = func(std::span<const HReal>(point));
+						point[i] = x[i];
+
+						return y;
+					};
+
+					approximateGradient[i] = analysis::derivative(partialFunc, x[i]);
+				}
+			}
+
+			const std::chrono::duration<double, std::micro> finiteDifferenceTime = Clock::now() - startTime;
+
+			HReal error = ZERO;
+			for (size_t i = 0; i < count; ++i)
+			{
+				error = max(error, analysis::getError(gradient[i], approximateGradient[i]));
+			}
+
+			cout << "[Tape][TC" << inOutTestCount << "] " << count << " parameters: reverse-mode "
+				<< tapeTime.count() / numRepeats << " us (1 evaluation), finite differences "
+				<< finiteDifferenceTime.count() / numRepeats << " us ("
+				<< numEvaluations / numRepeats << " evaluations), difference = " << error << endl;
+
+			if (error > SMALL_NUMBER)
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[Tape][TC" << inOutTestCount << "][Error] " << __LINE__ << ": difference "
+					<< error << " is bigger than expected " << SMALL_NUMBER << endl;
+
+				const auto errorMsg = msg.view();
+				cerr << errorMsg;
+
+				outErrorMessages.emplace_back(errorMsg);
+			}
+		}
+	}
+
+	{
+		cout << endl << "[Tape][TC" << ++inOutTestCount << "] Powers at zero" << endl;
+
+		auto powers = [](auto xs)
+		{
+			return pow(xs[0], 0.5) + pow(xs[1], 1) + pow(xs[2], 2);
+		};
+
+		const HReal x[] = { ZERO, ZERO, ZERO };
+		HReal gradient[3] = {};
+
+		Tape tape;
+		const HReal value = tape.gradient(powers, x, gradient);
+
+		cout << "[Tape][TC" << inOutTestCount << "] value = " << value << ", gradient = ("
+			<< gradient[0] << ", " << gradient[1] << ", " << gradient[2] << ")" << endl;
+
+		// x^0.5 has an infinite slope at zero, but neither its value nor its partial is NaN.
+		if (value != ZERO || !(gradient[0] > ZERO) || gradient[1] != ONE || gradient[2] != ZERO)
+		{
+			++errorCount;
+
+			ostringstream msg;
+			msg << "[Tape][TC" << inOutTestCount << "][Error] " << __LINE__ << ": value "
+				<< value << " and gradient (" << gradient[0] << ", " << gradient[1] << ", " << gradient[2]
+				<< ") are expected to be 0 and (inf, 1, 0)" << endl;
+
+			const auto errorMsg = msg.view();
+			cerr << errorMsg;
+
+			outErrorMessages.emplace_back(errorMsg);
+		}
+	}
+
+	return errorCount;
+}
+#endif // DO_TEST
+
+} // autodiff
+} // hmath
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "hmatharena.h"
+#include "hmathconfig.h"
+#include "hmathconstants.h"
+#include "hmathtypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace hmath
+{
+namespace autodiff
+{
+	// Operation recorded on a Tape, with the partial derivatives to its operands.
+	struct TapeNode final
+	{
+		TapeNode* previous;
+		TapeNode* parents[2];
+		HReal partials[2];
+		HReal adjoint;
+	};
+
+	class Variable;
+
+	// Reverse-mode automatic differentiation.
+	// Operations on Variables are recorded as nodes in an arena, and one backward sweep
+	// gives the derivatives of the output with respect to every input,
+	// i.e. a full gradient for a small multiple of the cost of one evaluation.
+	// The arena is rewound between evaluations, so the steady state doesn't allocate.
+	class Tape final
+	{
+	private:
+		Arena arena;
+		TapeNode* last;
+		size_t numNodes;
+		std::vector<Variable> inputs;
+
+	public:
+		explicit Tape(size_t blockSize = Arena::DEFAULT_BLOCK_SIZE);
+		Tape(const Tape&) = delete;
+		~Tape() = default;
+
+		Tape& operator= (const Tape&) = delete;
+
+		void reset();
+		Variable createVariable(HReal value);
+
+		TapeNode* record(TapeNode* parent0, HReal partial0, TapeNode* parent1, HReal partial1)
+		{
+			auto node = arena.create<TapeNode>();
+			node->previous = last;
+			node->parents[0] = parent0;
+			node->parents[1] = parent1;
+			node->partials[0] = partial0;
+			node->partials[1] = partial1;
+			node->adjoint = ZERO;
+
+			last = node;
+			++numNodes;
+
+			return node;
+		}
+
+		// Accumulates the adjoints of every recorded node, d output / d node.
+		void propagate(const Variable& output);
+
+		HReal getAdjoint(const Variable& variable) const;
+		size_t getNumNodes() const;
+
+		// Evaluates func(std::span<const Variable>) -> Variable at x, and writes d func / d x into outGradient.
+		// Returns the value of the function.
+		template <typename TFunc>
+		HReal gradient(const TFunc& func, std::span<const HReal> x, std::span<HReal> outGradient);
+
+#if DO_TEST
+		static int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
+#endif // DO_TEST
+	};
+
+	// Real number of which operations are recorded on a Tape.
+	// Variables not created by a Tape are constants.
+	class Variable final
+	{
+		friend class Tape;
+
+	private:
+		Tape* tape;
+		TapeNode* node;
+		HReal value;
+
+	public:
+		Variable(HReal constant = ZERO)
+			: tape(nullptr), node(nullptr), value(constant)
+		{
+		}
+
+		HReal getValue() const { return value; }
+
+		friend Variable operator- (const Variable& x)
+		{
+			return unary(x, -x.value, MINUS_ONE);
+		}
+
+		friend Variable operator+ (const Variable& lhs, const Variable& rhs)
+		{
+			return binary(lhs, rhs, lhs.value + rhs.value, ONE, ONE);
+		}
+
+		friend Variable operator- (const Variable& lhs, const Variable& rhs)
+		{
+			return binary(lhs, rhs, lhs.value - rhs.value, ONE, MINUS_ONE);
+		}
+
+		friend Variable operator* (const Variable& lhs, const Variable& rhs)
+		{
+			return binary(lhs, rhs, lhs.value * rhs.value, rhs.value, lhs.value);
+		}
+
+		friend Variable operator/ (const Variable& lhs, const Variable& rhs)
+		{
+			const HReal inverse = ONE / rhs.value;
+			const HReal y = lhs.value * inverse;
+
+			return binary(lhs, rhs, y, inverse, -y * inverse);
+		}
+
+		Variable& operator+= (const Variable& rhs) { return *this = *this + rhs; }
+		Variable& operator-= (const Variable& rhs) { return *this = *this - rhs; }
+		Variable& operator*= (const Variable& rhs) { return *this = *this * rhs; }
+		Variable& operator/= (const Variable& rhs) { return *this = *this / rhs; }
+
+		friend Variable exp(const Variable& x)
+		{
+			const HReal y = std::exp(x.value);
+			return unary(x, y, y);
+		}
+
+		friend Variable log(const Variable& x) { return unary(x, std::log(x.value), ONE / x.value); }
+
+		friend Variable sqrt(const Variable& x)
+		{
+			const HReal y = std::sqrt(x.value);
+			return unary(x, y, HALF / y);
+		}
+
+		friend Variable sin(const Variable& x) { return unary(x, std::sin(x.value), std::cos(x.value)); }
+		friend Variable cos(const Variable& x) { return unary(x, std::cos(x.value), -std::sin(x.value)); }
+
+		friend Variable tan(const Variable& x)
+		{
+			const HReal y = std::tan(x.value);
+			return unary(x, y, ONE + y * y);
+		}
+
+		// As pow of Dual, the value is x^e, and the partial e x^(e - 1) is evaluated directly at zero only.
+		friend Variable pow(const Variable& x, HReal exponent)
+		{
+			const HReal y = std::pow(x.value, exponent);
+
+			if (x.value != ZERO)
+				return unary(x, y, exponent * y / x.value);
+
+			return unary(x, y, exponent == ZERO ? ZERO : exponent * std::pow(x.value, exponent - ONE));
+		}
+
+	private:
+		Variable(Tape* inTape, TapeNode* inNode, HReal inValue)
+			: tape(inTape), node(inNode), value(inValue)
+		{
+		}
+
+		static Variable unary(const Variable& x, HReal y, HReal dx)
+		{
+			if (x.tape == nullptr)
+				return Variable(y);
+
+			return Variable(x.tape, x.tape->record(x.node, dx, nullptr, ZERO), y);
+		}
+
+		static Variable binary(const Variable& lhs, const Variable& rhs, HReal y, HReal dlhs, HReal drhs)
+		{
+			Tape* tape = lhs.tape != nullptr ? lhs.tape : rhs.tape;
+			if (tape == nullptr)
+				return Variable(y);
+
+			return Variable(tape, tape->record(lhs.node, dlhs, rhs.node, drhs), y);
+		}
+	};
+
+	template <typename TFunc>
+	HReal Tape::gradient(const TFunc& func, std::span<const HReal> x, std::span<HReal> outGradient)
+	{
+		reset();
+
+		inputs.clear();
+		for (auto value : x)
+		{
+			inputs.push_back(createVariable(value));
+		}
+
+		const Variable y = func(std::span<const Variable>(inputs));
+		propagate(y);
+
+		const size_t count = std::min(x.size(), outGradient.size());
+		for (size_t i = 0; i < count; ++i)
+		{
+			outGradient[i] = getAdjoint(inputs[i]);
+		}
+
+		return y.getValue();
+	}
+
+} // autodiff
+} // hmath
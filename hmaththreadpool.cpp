@@ -0,0 +1,274 @@
+#include "hmaththreadpool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+
+namespace hmath
+{
+
+namespace
+{
+	// Set while a thread runs chunks, so that nested loops don't wait on the pool they run in.
+	thread_local bool bInsideChunk = false;
+}
+
+ThreadPool::ThreadPool(size_t numThreads)
+	: job(nullptr)
+	, invoker(nullptr)
+	, jobCount(0)
+	, jobChunkSize(1)
+	, numChunks(0)
+	, nextChunk(0)
+	, numFinished(0)
+	, generation(0)
+	, bStopping(false)
+{
+	if (numThreads == 0)
+	{
+		numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	workers.reserve(numThreads - 1);
+
+	for (size_t i = 1; i < numThreads; ++i)
+	{
+		workers.emplace_back([this]() { work(); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(mutex);
+		bStopping = true;
+	}
+
+	wakeCondition.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+ThreadPool& ThreadPool::getDefault()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+size_t ThreadPool::getNumThreads() const
+{
+	return workers.size() + 1;
+}
+
+size_t ThreadPool::getNumChunks(size_t count, size_t chunkSize)
+{
+	chunkSize = std::max<size_t>(1, chunkSize);
+	return (count + chunkSize - 1) / chunkSize;
+}
+
+void ThreadPool::run(size_t count, size_t chunkSize, const void* inJob, TInvoker inInvoker)
+{
+	chunkSize = std::max<size_t>(1, chunkSize);
+	const size_t chunks = getNumChunks(count, chunkSize);
+
+	if (workers.empty() || chunks <= 1 || bInsideChunk)
+	{
+		for (size_t chunk = 0; chunk < chunks; ++chunk)
+		{
+			const size_t begin = chunk * chunkSize;
+			inInvoker(inJob, chunk, begin, std::min(count, begin + chunkSize));
+		}
+
+		return;
+	}
+
+	std::lock_guard jobLock(jobMutex);
+
+	{
+		std::lock_guard lock(mutex);
+
+		job = inJob;
+		invoker = inInvoker;
+		jobCount = count;
+		jobChunkSize = chunkSize;
+		numChunks = chunks;
+		nextChunk.store(0);
+		numFinished = 0;
+		++generation;
+	}
+
+	wakeCondition.notify_all();
+
+	runChunks();
+
+	// Every worker finishes the generation before the job is released,
+	// so that no worker reads a job of which the caller has returned.
+	std::unique_lock lock(mutex);
+	doneCondition.wait(lock, [this]() { return numFinished == workers.size(); });
+}
+
+void ThreadPool::runChunks()
+{
+	bInsideChunk = true;
+
+	for (size_t chunk = nextChunk.fetch_add(1); chunk < numChunks; chunk = nextChunk.fetch_add(1))
+	{
+		const size_t begin = chunk * jobChunkSize;
+		invoker(job, chunk, begin, std::min(jobCount, begin + jobChunkSize));
+	}
+
+	bInsideChunk = false;
+}
+
+void ThreadPool::work()
+{
+	uint64_t lastGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock lock(mutex);
+			wakeCondition.wait(lock, [this, lastGeneration]() { return bStopping || generation != lastGeneration; });
+
+			if (bStopping)
+				return;
+
+			lastGeneration = generation;
+		}
+
+		runChunks();
+
+		{
+			std::lock_guard lock(mutex);
+			++numFinished;
+		}
+
+		doneCondition.notify_one();
+	}
+}
+
+#if DO_TEST
+int ThreadPool::DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
+{
+	using namespace std;
+
+	int errorCount = 0;
+
+	auto report = [&](int line, const string& text)
+	{
+		++errorCount;
+
+		ostringstream msg;
+		msg << "[ThreadPool][TC" << inOutTestCount << "][Error] " << line << ": " << text << endl;
+
+		const auto errorMsg = msg.view();
+		cerr << errorMsg;
+
+		outErrorMessages.emplace_back(errorMsg);
+	};
+
+	{
+		cout << endl << "[ThreadPool][TC" << ++inOutTestCount << "] Parallel for" << endl;
+
+		constexpr size_t count = 100003;
+		constexpr size_t chunkSize = 1000;
+
+		ThreadPool pool(4);
+		vector<int> visits(count);
+
+		for (int repeat = 0; repeat < 10; ++repeat)
+		{
+			pool.parallelFor(count, chunkSize, [&visits](size_t, size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						++visits[i];
+					}
+				});
+		}
+
+		const auto numWrong = std::count_if(visits.begin(), visits.end(), [](int visit) { return visit != 10; });
+
+		cout << "[ThreadPool][TC" << inOutTestCount << "] threads = " << pool.getNumThreads()
+			<< ", chunks = " << getNumChunks(count, chunkSize) << ", wrong visits = " << numWrong << endl;
+
+		if (numWrong > 0)
+		{
+			report(__LINE__, to_string(numWrong) + " indices are not visited exactly once per loop.");
+		}
+	}
+
+	{
+		cout << endl << "[ThreadPool][TC" << ++inOutTestCount << "] Deterministic reduction" << endl;
+
+		constexpr size_t count = 1000000;
+		constexpr size_t chunkSize = 4096;
+
+		auto sum = [](ThreadPool& pool) -> double
+		{
+			vector<double> partials(getNumChunks(count, chunkSize));
+
+			pool.parallelFor(count, chunkSize, [&partials](size_t chunk, size_t begin, size_t end)
+				{
+					double partial = 0;
+					for (size_t i = begin; i < end; ++i)
+					{
+						partial += 1.0 / (1.0 + static_cast<double>(i));
+					}
+
+					partials[chunk] = partial;
+				});
+
+			double total = 0;
+			for (double partial : partials)
+			{
+				total += partial;
+			}
+
+			return total;
+		};
+
+		ThreadPool serial(1);
+		ThreadPool parallel3(3);
+		ThreadPool parallel8(8);
+
+		const double expected = sum(serial);
+		const bool bSame = sum(parallel3) == expected && sum(parallel8) == expected;
+
+		cout << "[ThreadPool][TC" << inOutTestCount << "] sum = " << expected << ", deterministic = " << bSame << endl;
+
+		if (!bSame)
+		{
+			report(__LINE__, "the reduction depends on the number of threads.");
+		}
+	}
+
+	{
+		cout << endl << "[ThreadPool][TC" << ++inOutTestCount << "] Nested parallel for" << endl;
+
+		ThreadPool pool(4);
+		std::atomic<size_t> numVisits = 0;
+
+		pool.parallelFor(16, 1, [&pool, &numVisits](size_t, size_t, size_t)
+			{
+				pool.parallelFor(100, 10, [&numVisits](size_t, size_t begin, size_t end)
+					{
+						numVisits += end - begin;
+					});
+			});
+
+		if (numVisits != 1600)
+		{
+			report(__LINE__, "nested loops visited " + to_string(numVisits.load()) + " indices, expected 1600.");
+		}
+	}
+
+	return errorCount;
+}
+#endif // DO_TEST
+
+} // hmath
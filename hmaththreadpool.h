@@ -0,0 +1,93 @@
+#pragma once
+
+#include "hmathconfig.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace hmath
+{
+	// Fixed set of worker threads running chunked loops.
+	// parallelFor splits [0, count) into chunks of a given size, of which results can be stored per chunk
+	// and merged in chunk order, so that a reduction is deterministic regardless of the number of threads.
+	class ThreadPool final
+	{
+		using TInvoker = void(*)(const void*, size_t, size_t, size_t);
+
+	private:
+		std::vector<std::thread> workers;
+
+		std::mutex jobMutex;
+		std::mutex mutex;
+		std::condition_variable wakeCondition;
+		std::condition_variable doneCondition;
+
+		const void* job;
+		TInvoker invoker;
+		size_t jobCount;
+		size_t jobChunkSize;
+		size_t numChunks;
+		std::atomic<size_t> nextChunk;
+		size_t numFinished;
+		uint64_t generation;
+		bool bStopping;
+
+	public:
+		// 0 threads uses every hardware thread. The calling thread also works on chunks,
+		// so numThreads - 1 workers are created.
+		explicit ThreadPool(size_t numThreads = 0);
+		ThreadPool(const ThreadPool&) = delete;
+		~ThreadPool();
+
+		ThreadPool& operator= (const ThreadPool&) = delete;
+
+		static ThreadPool& getDefault();
+
+		size_t getNumThreads() const;
+
+		static size_t getNumChunks(size_t count, size_t chunkSize);
+
+		// Calls func(chunk, begin, end) for every chunk of [0, count), and returns when all chunks are done.
+		// Nested calls from a chunk run serially on the calling thread.
+		template <typename TFunc>
+		void parallelFor(size_t count, size_t chunkSize, const TFunc& func)
+		{
+			run(count, chunkSize, &func, [](const void* inFunc, size_t chunk, size_t begin, size_t end)
+				{
+					(*static_cast<const TFunc*>(inFunc))(chunk, begin, end);
+				});
+		}
+
+		// Calls func(chunk, begin, end) for the same chunks as parallelFor, in order on the calling thread,
+		// for callers which haven't opted into running the given function concurrently.
+		template <typename TFunc>
+		static void serialFor(size_t count, size_t chunkSize, const TFunc& func)
+		{
+			chunkSize = std::max<size_t>(1, chunkSize);
+			const size_t chunks = getNumChunks(count, chunkSize);
+
+			for (size_t chunk = 0; chunk < chunks; ++chunk)
+			{
+				const size_t begin = chunk * chunkSize;
+				func(chunk, begin, std::min(count, begin + chunkSize));
+			}
+		}
+
+#if DO_TEST
+		static int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages);
+#endif // DO_TEST
+
+	private:
+		void run(size_t count, size_t chunkSize, const void* inJob, TInvoker inInvoker);
+		void runChunks();
+		void work();
+	};
+} // hmath
@@ -4,6 +4,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <span>
 
 
 namespace hmath
@@ -19,6 +20,9 @@ namespace hmath
 	// f:x -> y, where x and y are real numbers.
 	using TFunc1 = std::function<HReal(HReal)>;
 
+	// Function evaluating a batch of inputs at once, e.g. Polynomial::evaluate or bytecode::Program::evaluate.
+	using TBatchFunc1 = std::function<void(std::span<const HReal> values, std::span<HReal> outResults)>;
+
 	struct HRoot final
 	{
 		const HReal value;
@@ -1,9 +1,13 @@
 #include "hmathutil.h"
 
+#include "hmath.h"
+#include "hmathanalysis.h"
 #include "hmathbitops.h"
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 
 namespace hmath
@@ -68,25 +72,352 @@ namespace util
 		};
 	}
 
-	HReal compare(const TFunc1& func1, const TFunc1& func2, HReal start, HReal end, HReal step)
+	namespace
 	{
-		HReal error = ZERO;
+		// Splits the grid into chunks on the pool, or serially without one, and merges the results of the chunks
+		// in chunk order, so that the result is the same either way.
+		template <typename TResult, typename TChunkFunc, typename TMergeFunc>
+		TResult reduceChunks(ThreadPool* pool, size_t count, const TChunkFunc& chunkFunc, const TMergeFunc& mergeFunc)
+		{
+			const size_t numChunks = ThreadPool::getNumChunks(count, COMPARE_CHUNK_SIZE);
+			if (numChunks <= 1)
+				return chunkFunc(0, count);
+
+			std::vector<TResult> results(numChunks);
+
+			auto runChunk = [&results, &chunkFunc](size_t chunk, size_t begin, size_t end)
+			{
+				results[chunk] = chunkFunc(begin, end);
+			};
+
+			if (pool != nullptr)
+			{
+				pool->parallelFor(count, COMPARE_CHUNK_SIZE, runChunk);
+			}
+			else
+			{
+				ThreadPool::serialFor(count, COMPARE_CHUNK_SIZE, runChunk);
+			}
+
+			TResult result = std::move(results[0]);
+			for (size_t i = 1; i < numChunks; ++i)
+			{
+				mergeFunc(result, results[i]);
+			}
+
+			return result;
+		}
+
+		HReal reduceMaxError(ThreadPool* pool, size_t count, const auto& chunkFunc)
+		{
+			return reduceChunks<HReal>(pool, count, chunkFunc, [](HReal& error, HReal chunkError)
+				{
+					error = std::max(error, chunkError);
+				});
+		}
+
+		ComparisonReport reduceReport(ThreadPool* pool, size_t count, const auto& chunkFunc)
+		{
+			return reduceChunks<ComparisonReport>(pool, count, chunkFunc,
+				[](ComparisonReport& report, const ComparisonReport& chunkReport)
+				{
+					report.merge(chunkReport);
+				});
+		}
+
+		// Calls visit(x, func1(x), func2(x)) for the samples [begin, end) of the grid.
+		template <typename TVisitor>
+		void visitSamples(FunctionRef func1, FunctionRef func2, HReal start, HReal step,
+			size_t begin, size_t end, TVisitor&& visit)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				const HReal x = start + static_cast<HReal>(i) * step;
+				visit(x, func1(x), func2(x));
+			}
+		}
+
+		// Evaluates the samples [begin, end) of the grid by one call of each function.
+		template <typename TVisitor>
+		void visitSamples(const TBatchFunc1& func1, const TBatchFunc1& func2, HReal start, HReal step,
+			size_t begin, size_t end, TVisitor&& visit)
+		{
+			const size_t width = end - begin;
+
+			std::vector<HReal> buffer(width * 3);
+			const std::span<HReal> xs(buffer.data(), width);
+			const std::span<HReal> ys(buffer.data() + width, width);
+			const std::span<HReal> ys2(buffer.data() + width * 2, width);
+
+			for (size_t i = 0; i < width; ++i)
+			{
+				xs[i] = start + static_cast<HReal>(begin + i) * step;
+			}
+
+			func1(xs, ys);
+			func2(xs, ys2);
+
+			for (size_t i = 0; i < width; ++i)
+			{
+				visit(xs[i], ys[i], ys2[i]);
+			}
+		}
+
+		const std::array<HReal, ComparisonReport::NUM_HISTOGRAM_BINS - 1> HISTOGRAM_BOUNDS = []()
+		{
+			std::array<HReal, ComparisonReport::NUM_HISTOGRAM_BINS - 1> bounds;
+
+			for (size_t i = 0; i < bounds.size(); ++i)
+			{
+				bounds[i] = std::pow(static_cast<HReal>(10),
+					static_cast<HReal>(ComparisonReport::HISTOGRAM_MIN_EXPONENT + static_cast<int>(i)));
+			}
+
+			return bounds;
+		}();
+	} // anonymous
+
+	size_t getGridSize(HReal start, HReal end, HReal step)
+	{
+		if (!(step > ZERO))
+		{
+			using namespace std;
+			cerr << "[hmath][Error] " << __func__ << ": step should be positive, but " << step << endl;
+
+			return 0;
+		}
+
+		if (!(end > start))
+			return 0;
+
+		const HReal numSteps = std::ceil((end - start) / step);
+		if (!std::isfinite(numSteps))
+		{
+			using namespace std;
+			cerr << "[hmath][Error] " << __func__ << ": too many samples, range = ["
+				<< start << ", " << end << "), step = " << step << endl;
+
+			return 0;
+		}
+
+		// Corrects the rounding of the division, so that every sample is in [start, end).
+		size_t count = static_cast<size_t>(numSteps);
+
+		while (count > 0 && start + static_cast<HReal>(count - 1) * step >= end)
+			--count;
+
+		while (start + static_cast<HReal>(count) * step < end)
+			++count;
+
+		return count;
+	}
+
+	namespace
+	{
+		// Max absolute difference over the grid, on the pool or serially without one.
+		template <typename TFunc>
+		HReal compareOn(ThreadPool* pool, const TFunc& func1, const TFunc& func2, HReal start, HReal end, HReal step)
+		{
+			const size_t count = getGridSize(start, end, step);
+
+			return reduceMaxError(pool, count, [&func1, &func2, start, step](size_t begin, size_t end) -> HReal
+				{
+					HReal error = ZERO;
+
+					visitSamples(func1, func2, start, step, begin, end, [&error](HReal, HReal y, HReal y2)
+						{
+							error = std::max(error, std::abs(y2 - y));
+						});
+
+					return error;
+				});
+		}
+
+		HReal compareBatches(ThreadPool* pool, const TBatchFunc1& func1, const TBatchFunc1& func2,
+			HReal start, HReal end, HReal step)
+		{
+			if (!func1 || !func2)
+			{
+				using namespace std;
+				cerr << "[hmath][Error] compare: func is null." << endl;
+
+				return ZERO;
+			}
+
+			return compareOn(pool, func1, func2, start, end, step);
+		}
+	} // anonymous
+
+	HReal compare(FunctionRef func1, FunctionRef func2, HReal start, HReal end, HReal step)
+	{
+		return compareOn(nullptr, func1, func2, start, end, step);
+	}
+
+	HReal compare(ThreadPool& pool, FunctionRef func1, FunctionRef func2, HReal start, HReal end, HReal step)
+	{
+		return compareOn(&pool, func1, func2, start, end, step);
+	}
+
+	HReal compare(const TBatchFunc1& func1, const TBatchFunc1& func2, HReal start, HReal end, HReal step)
+	{
+		return compareBatches(nullptr, func1, func2, start, end, step);
+	}
+
+	HReal compare(ThreadPool& pool, const TBatchFunc1& func1, const TBatchFunc1& func2,
+		HReal start, HReal end, HReal step)
+	{
+		return compareBatches(&pool, func1, func2, start, end, step);
+	}
+
+	void ComparisonReport::add(HReal x, HReal y1, HReal y2)
+	{
+		++numSamples;
+
+		const HReal error = std::abs(y2 - y1);
+		const uint64_t ulp = bitops::getUlpDistance(y1, y2);
+
+		if (ulp > maxUlp || numSamples == 1)
+		{
+			maxUlp = ulp;
+			maxUlpX = x;
+		}
+
+		if (std::isnan(error))
+		{
+			++numNaNs;
+			++histogram.back();
+
+			return;
+		}
+
+		if (error > maxError || numSamples == numNaNs + 1)
+		{
+			maxError = error;
+			maxErrorX = x;
+		}
+
+		sumError += error;
+		sumSquaredError += error * error;
+
+		++histogram[getHistogramBin(error)];
+	}
+
+	void ComparisonReport::merge(const ComparisonReport& rhs)
+	{
+		if (rhs.numSamples == 0)
+			return;
+
+		if (numSamples == 0)
+		{
+			*this = rhs;
+			return;
+		}
+
+		if (rhs.maxUlp > maxUlp)
+		{
+			maxUlp = rhs.maxUlp;
+			maxUlpX = rhs.maxUlpX;
+		}
+
+		const bool bNoError = numSamples == numNaNs;
+		const bool bRhsNoError = rhs.numSamples == rhs.numNaNs;
+
+		if (!bRhsNoError && (bNoError || rhs.maxError > maxError))
+		{
+			maxError = rhs.maxError;
+			maxErrorX = rhs.maxErrorX;
+		}
+
+		numSamples += rhs.numSamples;
+		numNaNs += rhs.numNaNs;
+		sumError += rhs.sumError;
+		sumSquaredError += rhs.sumSquaredError;
+
+		for (size_t i = 0; i < NUM_HISTOGRAM_BINS; ++i)
+		{
+			histogram[i] += rhs.histogram[i];
+		}
+	}
+
+	HReal ComparisonReport::getMeanError() const
+	{
+		const size_t count = numSamples - numNaNs;
+		return count > 0 ? sumError / static_cast<HReal>(count) : ZERO;
+	}
+
+	HReal ComparisonReport::getRmsError() const
+	{
+		const size_t count = numSamples - numNaNs;
+		return count > 0 ? std::sqrt(sumSquaredError / static_cast<HReal>(count)) : ZERO;
+	}
+
+	size_t ComparisonReport::getHistogramBin(HReal error)
+	{
+		if (std::isnan(error))
+			return NUM_HISTOGRAM_BINS - 1;
+
+		return std::upper_bound(HISTOGRAM_BOUNDS.begin(), HISTOGRAM_BOUNDS.end(), error) - HISTOGRAM_BOUNDS.begin();
+	}
 
-		for (HReal x = start; x < end; x += step)
+	HReal ComparisonReport::getHistogramLowerBound(size_t bin)
+	{
+		if (bin == 0)
+			return ZERO;
+
+		return HISTOGRAM_BOUNDS[std::min(bin, HISTOGRAM_BOUNDS.size()) - 1];
+	}
+
+	namespace
+	{
+		// Report over the grid, on the pool or serially without one.
+		template <typename TFunc>
+		ComparisonReport getReportOn(ThreadPool* pool, const TFunc& func1, const TFunc& func2,
+			HReal start, HReal end, HReal step)
+		{
+			const size_t count = getGridSize(start, end, step);
+
+			return reduceReport(pool, count, [&func1, &func2, start, step](size_t begin, size_t end)
+				{
+					ComparisonReport report;
+
+					visitSamples(func1, func2, start, step, begin, end, [&report](HReal x, HReal y, HReal y2)
+						{
+							report.add(x, y, y2);
+						});
+
+					return report;
+				});
+		}
+	} // anonymous
+
+	ComparisonReport getComparisonReport(FunctionRef func1, FunctionRef func2, HReal start, HReal end, HReal step)
+	{
+		return getReportOn(nullptr, func1, func2, start, end, step);
+	}
+
+	ComparisonReport getComparisonReport(ThreadPool& pool, FunctionRef func1, FunctionRef func2,
+		HReal start, HReal end, HReal step)
+	{
+		return getReportOn(&pool, func1, func2, start, end, step);
+	}
+
+	ComparisonReport getComparisonReport(ThreadPool& pool, const TBatchFunc1& func1, const TBatchFunc1& func2,
+		HReal start, HReal end, HReal step)
+	{
+		if (!func1 || !func2)
 		{
-			auto y = func1(x);
-			auto y2 = func2(x);
-			auto delta = abs(y2 - y);
+			using namespace std;
+			cerr << "[hmath][Error] " << __func__ << ": func is null." << endl;
 
-			error = std::max(error, delta);
+			return ComparisonReport();
 		}
 
-		return error;
+		return getReportOn(&pool, func1, func2, start, end, step);
 	}
 
 	std::optional<HReal> solveLinearEquation(HReal a, HReal b)
 	{
-		if (abs(a) < MIN_NUMBER)
+		if (std::abs(a) < MIN_NUMBER)
 			return std::optional<HReal>();
 
 		return -b / a;
@@ -109,6 +440,14 @@ namespace util
 	}
 
 #if DO_TEST
+	namespace
+	{
+		HReal squareMinusOne(HReal x)
+		{
+			return x * x - 1;
+		}
+	} // anonymous
+
 	int DoTest(int& inOutTestCount, std::vector<std::string>& outErrorMessages)
 	{
 		using namespace std;
@@ -434,6 +773,377 @@ namespace util
 				<< error << endl;
 		}
 
+		{
+			cout << "[hmathutil][TC" << ++inOutTestCount << "] Function reference test" << endl;
+
+			struct CopyCounter final
+			{
+				int* numCopies;
+
+				CopyCounter(int* inNumCopies) : numCopies(inNumCopies) {}
+				CopyCounter(const CopyCounter& rhs) : numCopies(rhs.numCopies) { ++(*numCopies); }
+
+				HReal operator() (HReal x) const { return x * x; }
+			};
+
+			int numCopies = 0;
+			const CopyCounter func(&numCopies);
+			auto trueFunc = [](HReal x) -> HReal { return x * x; };
+
+			const auto allocationCount = GetAllocationCount();
+			auto error = compare(func, trueFunc, -1, 1, 0.001);
+			auto dy = analysis::derivative(func, 1);
+			const auto numAllocations = GetAllocationCount() - allocationCount;
+
+			const TFunc1 emptyFunc;
+			const bool bNullRef = !FunctionRef(emptyFunc) && !FunctionRef() && FunctionRef(func);
+
+			// Free functions bind by their pointer.
+			HReal (*const nullFunction)(HReal) = nullptr;
+			int count = 0;
+			const auto root = analysis::bisectionMethod(count, squareMinusOne, 0, 2);
+			error = std::max(error, compare(squareMinusOne, &squareMinusOne, -1, 1, 0.001));
+			error = std::max(error, std::abs(FunctionRef(squareMinusOne)(3) - 8));
+
+			if (!root || std::abs(root->value - 1) > SMALL_NUMBER || FunctionRef(nullFunction))
+			{
+				error = MAX_NUMBER;
+			}
+
+			if (numCopies != 0 || numAllocations != 0 || error > EPSILON
+				|| std::abs(dy - 2) > analysis::DERIVATIVE_STEP || !bNullRef)
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[hmathutil][TC" << inOutTestCount
+					<< "] function reference test failed, copies = " << numCopies
+					<< ", allocations = " << numAllocations << ", error = " << error
+					<< ", dy = " << dy << ", null reference = " << bNullRef << endl;
+
+				auto msgStr = msg.view();
+				cerr << msgStr;
+
+				outErrorMessages.emplace_back(msgStr);
+			}
+
+			cout << "[hmathutil][TC" << inOutTestCount << "] Function reference test: Done, copies = "
+				<< numCopies << ", allocations = " << numAllocations << endl;
+		}
+
+		{
+			cout << "[hmathutil][TC" << ++inOutTestCount << "] Expression template test" << endl;
+
+			auto func1 = [](HReal x) -> HReal { return x * x; };
+			auto func2 = [](HReal x) -> HReal { return x + 3; };
+
+			const auto allocationCount = GetAllocationCount();
+			const auto expression = composite(lift(func1) + lift(func2) * 2.0 - 1.0 / (identity() + 4.0),
+				-identity() * 0.5);
+			const auto numAllocations = GetAllocationCount() - allocationCount;
+
+			const TFunc1 function = composite(func1 + func2 * 2.0 - [](HReal x) { return 1.0 / (x + 4.0); },
+				[](HReal x) { return -x * 0.5; });
+			const TFunc1 erased = expression.asFunction();
+
+			auto error = std::max(compare(expression, function, -1, 1, 0.001), compare(erased, function, -1, 1, 0.001));
+
+			std::vector<HReal> values(1000);
+			std::vector<HReal> results(values.size());
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				values[i] = -ONE + static_cast<HReal>(i) * 0.002;
+			}
+
+			expression.evaluate(values, results);
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				error = std::max(error, std::abs(results[i] - function(values[i])));
+			}
+
+			if (error > EPSILON || numAllocations != 0)
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[hmathutil][TC" << inOutTestCount
+					<< "] expression template test failed with error = " << error
+					<< ", allocations = " << numAllocations << endl;
+
+				auto msgStr = msg.view();
+				cerr << msgStr;
+
+				outErrorMessages.emplace_back(msgStr);
+			}
+
+			cout << "[hmathutil][TC" << inOutTestCount << "] Expression template test: Done, error = "
+				<< error << endl;
+		}
+
+		{
+			cout << "[hmathutil][TC" << ++inOutTestCount << "] Benchmark: expression template vs TFunc1 operators" << endl;
+
+			using Clock = std::chrono::steady_clock;
+
+			constexpr int numIterations = 100000;
+
+			auto measure = [](const auto& func) -> double
+			{
+				HReal sum = ZERO;
+
+				const auto startTime = Clock::now();
+
+				for (int i = 0; i < numIterations; ++i)
+				{
+					sum += func(static_cast<HReal>(i) * MICRO);
+				}
+
+				const auto endTime = Clock::now();
+				const std::chrono::duration<double, std::nano> elapsed = endTime - startTime;
+
+				volatile HReal sink = sum;
+				(void)sink;
+
+				return elapsed.count() / numIterations;
+			};
+
+			// 20 nested operations
+			auto quadratic = [](HReal x) -> HReal { return x * x + 1.0; };
+
+			TFunc1 function = quadratic;
+			for (int i = 0; i < 5; ++i)
+			{
+				function = composite(function * 0.5 - function, TFunc1(quadratic));
+			}
+
+			auto step = [quadratic](const auto& f) { return composite(f * 0.5 - f, lift(quadratic)); };
+			const auto expression = step(step(step(step(step(lift(quadratic))))));
+
+			const auto functionTime = measure(function);
+			const auto expressionTime = measure(expression);
+			const auto error = compare(expression, function, 0, 1, 0.001);
+
+			if (error > EPSILON)
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[hmathutil][TC" << inOutTestCount
+					<< "] expression template benchmark result differs with error = " << error << endl;
+
+				auto msgStr = msg.view();
+				cerr << msgStr;
+
+				outErrorMessages.emplace_back(msgStr);
+			}
+
+			cout << "[hmathutil][TC" << inOutTestCount << "] TFunc1 " << functionTime
+				<< " ns, expression template " << expressionTime << " ns" << endl;
+		}
+
+		{
+			cout << "[hmathutil][TC" << ++inOutTestCount << "] Compare on an exact grid" << endl;
+
+			auto zero = [](HReal) -> HReal { return ZERO; };
+			auto identity = [](HReal x) -> HReal { return x; };
+
+			const auto gridSize = getGridSize(0, 1, 0.001);
+			const auto error = compare(identity, zero, 0, 1, 0.1);
+			const auto lastX = static_cast<HReal>(9) * 0.1;
+
+			if (gridSize != 1000 || error != lastX || getGridSize(1, 0, 0.1) != 0)
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[hmathutil][TC" << inOutTestCount
+					<< "] grid size = " << gridSize << ", expected 1000, max error = " << error
+					<< ", expected " << lastX << endl;
+
+				auto msgStr = msg.view();
+				cerr << msgStr;
+
+				outErrorMessages.emplace_back(msgStr);
+			}
+
+			cout << "[hmathutil][TC" << inOutTestCount << "] Compare on an exact grid: Done, grid size = "
+				<< gridSize << endl;
+		}
+
+		{
+			cout << "[hmathutil][TC" << ++inOutTestCount << "] Parallel and batched compare" << endl;
+
+			using Clock = std::chrono::steady_clock;
+
+			auto func = [](HReal x) -> HReal { return std::sin(x) * x; };
+			auto approxFunc = [](HReal x) -> HReal { return x * x - (x * x * x * x) / 6; };
+
+			auto batchFunc = [func](std::span<const HReal> values, std::span<HReal> outResults)
+			{
+				for (size_t i = 0; i < values.size(); ++i)
+				{
+					outResults[i] = func(values[i]);
+				}
+			};
+
+			auto batchApproxFunc = [approxFunc](std::span<const HReal> values, std::span<HReal> outResults)
+			{
+				for (size_t i = 0; i < values.size(); ++i)
+				{
+					outResults[i] = approxFunc(values[i]);
+				}
+			};
+
+			constexpr HReal step = 1e-6;
+
+			ThreadPool parallel3(3);
+			ThreadPool& pool = ThreadPool::getDefault();
+
+			// Without a pool, compare runs on the calling thread, so stateful functions don't race.
+			const auto callerId = std::this_thread::get_id();
+			size_t numCalls = 0;
+			bool bCalledElsewhere = false;
+
+			auto countedFunc = [&](HReal x) -> HReal
+			{
+				++numCalls;
+				bCalledElsewhere = bCalledElsewhere || std::this_thread::get_id() != callerId;
+
+				return func(x);
+			};
+
+			auto startTime = Clock::now();
+			const auto serialError = compare(countedFunc, approxFunc, -1, 1, step);
+			const std::chrono::duration<double, std::milli> serialTime = Clock::now() - startTime;
+
+			startTime = Clock::now();
+			const auto parallelError = compare(pool, func, approxFunc, -1, 1, step);
+			const std::chrono::duration<double, std::milli> parallelTime = Clock::now() - startTime;
+
+			startTime = Clock::now();
+			const auto batchError = compare(pool, TBatchFunc1(batchFunc), TBatchFunc1(batchApproxFunc), -1, 1, step);
+			const std::chrono::duration<double, std::milli> batchTime = Clock::now() - startTime;
+
+			const auto parallel3Error = compare(parallel3, func, approxFunc, -1, 1, step);
+
+			cout << "[hmathutil][TC" << inOutTestCount << "] " << getGridSize(-1, 1, step) << " samples, error = "
+				<< serialError << ", serial " << serialTime.count() << " ms, "
+				<< pool.getNumThreads() << " threads " << parallelTime.count()
+				<< " ms, batched " << batchTime.count() << " ms" << endl;
+
+			if (parallelError != serialError || parallel3Error != serialError || batchError != serialError
+				|| numCalls != getGridSize(-1, 1, step) || bCalledElsewhere)
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[hmathutil][TC" << inOutTestCount
+					<< "] compare depends on threads or batching, serial = " << serialError
+					<< ", parallel = " << parallelError << ", 3 threads = " << parallel3Error
+					<< ", batched = " << batchError << ", or runs without a pool on other threads, calls = "
+					<< numCalls << endl;
+
+				auto msgStr = msg.view();
+				cerr << msgStr;
+
+				outErrorMessages.emplace_back(msgStr);
+			}
+		}
+
+		{
+			cout << "[hmathutil][TC" << ++inOutTestCount << "] Comparison report" << endl;
+
+			auto func = [](HReal x) -> HReal { return std::sin(x) * x; };
+			auto approxFunc = [](HReal x) -> HReal { return x * x - (x * x * x * x) / 6; };
+
+			auto batchFunc = [func](std::span<const HReal> values, std::span<HReal> outResults)
+			{
+				for (size_t i = 0; i < values.size(); ++i)
+				{
+					outResults[i] = func(values[i]);
+				}
+			};
+
+			auto batchApproxFunc = [approxFunc](std::span<const HReal> values, std::span<HReal> outResults)
+			{
+				for (size_t i = 0; i < values.size(); ++i)
+				{
+					outResults[i] = approxFunc(values[i]);
+				}
+			};
+
+			constexpr HReal step = 1e-5;
+
+			ThreadPool serial(1);
+			ThreadPool parallel3(3);
+
+			const auto report = getComparisonReport(serial, func, approxFunc, -1, 1, step);
+			const auto parallelReport = getComparisonReport(parallel3, func, approxFunc, -1, 1, step);
+			const auto batchReport = getComparisonReport(serial, TBatchFunc1(batchFunc), TBatchFunc1(batchApproxFunc),
+				-1, 1, step);
+
+			auto isSame = [](const ComparisonReport& lhs, const ComparisonReport& rhs) -> bool
+			{
+				return lhs.numSamples == rhs.numSamples && lhs.maxError == rhs.maxError
+					&& lhs.maxErrorX == rhs.maxErrorX && lhs.sumError == rhs.sumError
+					&& lhs.sumSquaredError == rhs.sumSquaredError && lhs.maxUlp == rhs.maxUlp
+					&& lhs.maxUlpX == rhs.maxUlpX && lhs.histogram == rhs.histogram;
+			};
+
+			// A single serial pass as the reference
+			ComparisonReport trueReport;
+			const size_t count = getGridSize(-1, 1, step);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const HReal x = -1 + static_cast<HReal>(i) * step;
+				trueReport.add(x, func(x), approxFunc(x));
+			}
+
+			size_t histogramCount = 0;
+			for (auto binCount : report.histogram)
+			{
+				histogramCount += binCount;
+			}
+
+			cout << "[hmathutil][TC" << inOutTestCount << "] samples = " << report.numSamples
+				<< ", max = " << report.maxError << " at " << report.maxErrorX
+				<< ", mean = " << report.getMeanError() << ", rms = " << report.getRmsError()
+				<< ", max ulp = " << report.maxUlp << " at " << report.maxUlpX << endl;
+
+			for (size_t bin = 0; bin < ComparisonReport::NUM_HISTOGRAM_BINS; ++bin)
+			{
+				if (report.histogram[bin] == 0)
+					continue;
+
+				cout << "[hmathutil][TC" << inOutTestCount << "] error >= "
+					<< ComparisonReport::getHistogramLowerBound(bin) << ": " << report.histogram[bin] << endl;
+			}
+
+			const bool bPassed = isSame(report, parallelReport) && isSame(report, batchReport)
+				&& report.maxError == compare(func, approxFunc, -1, 1, step)
+				&& report.maxErrorX == -1 && histogramCount == report.numSamples
+				&& std::abs(report.getMeanError() - trueReport.getMeanError()) < EPSILON
+				&& report.maxError == trueReport.maxError && report.maxUlp == trueReport.maxUlp
+				&& report.histogram == trueReport.histogram;
+
+			if (!bPassed)
+			{
+				++errorCount;
+
+				ostringstream msg;
+				msg << "[hmathutil][TC" << inOutTestCount << "] comparison report mismatch, max = "
+					<< report.maxError << " at " << report.maxErrorX << ", parallel max = "
+					<< parallelReport.maxError << ", batched max = " << batchReport.maxError
+					<< ", histogram count = " << histogramCount << endl;
+
+				auto msgStr = msg.view();
+				cerr << msgStr;
+
+				outErrorMessages.emplace_back(msgStr);
+			}
+		}
+
 		return errorCount;
 	}
 #endif // DO_TEST
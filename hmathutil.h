@@ -2,9 +2,18 @@
 
 #include "hmathconfig.h"
 #include "hmathconstants.h"
+#include "hmathexpression.h"
+#include "hmathfunctionref.h"
+#include "hmaththreadpool.h"
 #include "hmathtypes.h"
 
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 
 namespace hmath
@@ -17,8 +26,65 @@ namespace util
 	TFunc1 operator-(const TFunc1& left, const TFunc1& right);
 	TFunc1 operator*(const TFunc1& left, HReal right);
 	TFunc1 operator*(HReal left, const TFunc1& right);
-	
-	HReal compare(const TFunc1& func1, const TFunc1& func2, HReal start, HReal end, HReal step = SMALL_NUMBER);
+
+	static constexpr size_t COMPARE_CHUNK_SIZE = 4096;
+
+	// Number of samples x_i = start + i * step in [start, end).
+	size_t getGridSize(HReal start, HReal end, HReal step);
+
+	// Max absolute difference over the samples x_i = start + i * step in [start, end).
+	// The samples are split into chunks of COMPARE_CHUNK_SIZE. Given a pool, the chunks run in parallel on it,
+	// so the functions should be safe to call concurrently; otherwise they run serially on the calling thread.
+	// The result doesn't depend on the number of threads.
+	HReal compare(FunctionRef func1, FunctionRef func2, HReal start, HReal end, HReal step = SMALL_NUMBER);
+	HReal compare(ThreadPool& pool, FunctionRef func1, FunctionRef func2, HReal start, HReal end, HReal step = SMALL_NUMBER);
+	HReal compare(const TBatchFunc1& func1, const TBatchFunc1& func2, HReal start, HReal end, HReal step = SMALL_NUMBER);
+	HReal compare(ThreadPool& pool, const TBatchFunc1& func1, const TBatchFunc1& func2,
+		HReal start, HReal end, HReal step = SMALL_NUMBER);
+
+	// Error statistics of func2 against func1 over a grid, gathered in a single pass.
+	// Reports of consecutive ranges are merged in order, so a grid can be split across threads.
+	struct ComparisonReport final
+	{
+		// Bin 0 counts errors below 1e-17, bin k errors in [1e(k-18), 1e(k-17)),
+		// and the last bin errors of 100 or above and NaNs.
+		static constexpr size_t NUM_HISTOGRAM_BINS = 21;
+		static constexpr int HISTOGRAM_MIN_EXPONENT = -17;
+
+		size_t numSamples = 0;
+		size_t numNaNs = 0;
+
+		HReal maxError = ZERO;
+		HReal maxErrorX = ZERO;
+		HReal sumError = ZERO;
+		HReal sumSquaredError = ZERO;
+
+		uint64_t maxUlp = 0;
+		HReal maxUlpX = ZERO;
+
+		std::array<size_t, NUM_HISTOGRAM_BINS> histogram = {};
+
+		void add(HReal x, HReal y1, HReal y2);
+
+		// Appends the samples of rhs, which come after the samples of this report.
+		// The first of equal worst errors is kept.
+		void merge(const ComparisonReport& rhs);
+
+		HReal getMeanError() const;
+		HReal getRmsError() const;
+
+		static size_t getHistogramBin(HReal error);
+		static HReal getHistogramLowerBound(size_t bin);
+	};
+
+	// Runs as compare does, in parallel on the given pool only.
+	ComparisonReport getComparisonReport(FunctionRef func1, FunctionRef func2,
+		HReal start, HReal end, HReal step = SMALL_NUMBER);
+	ComparisonReport getComparisonReport(ThreadPool& pool, FunctionRef func1, FunctionRef func2,
+		HReal start, HReal end, HReal step = SMALL_NUMBER);
+	ComparisonReport getComparisonReport(ThreadPool& pool, const TBatchFunc1& func1, const TBatchFunc1& func2,
+		HReal start, HReal end, HReal step = SMALL_NUMBER);
+
 	std::optional<HReal> solveLinearEquation(HReal a, HReal b);
 	std::optional<std::pair<HReal, HReal>> solveQuadraticEquation(HReal a, HReal b, HReal c);
 #if DO_TEST